@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: bench_lines.c is a micro-benchmark comparing the fixed point
+ *    line rasterizer in draw.c with the floating point one it replaced, on
+ *    random lines drawn into memory.  Long lines stand in for ship outlines
+ *    at high zoom.  Run it as: ./bench_lines [number of lines]
+ ___________________________________________________________________________*/
+
+#include "draw.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_NUM_LINES 100000
+#define NUM_CHECKED 300   /* Lines compared one at a time. */
+#define MAX_ROUNDING 2    /* Most a pixel may differ by from rounding, */
+#define MAX_CLIPPED 3     /* and on a line clipped to the screen. */
+#define BORDER 2          /* Pixels from the edge clipping may change. */
+#define WIDTH 800
+#define HEIGHT 600
+
+/* The line rasterizer as it was, stepping a double and drawing each pixel
+   through the public calls. */
+static void oldLine(int x1, int y1, int x2, int y2, Color_T color,
+                    Uint8 alpha) {
+   int xaa, yaa, *a, *b, *a2, da, xd, yd;
+   double aa, db, realb;
+
+   if ((x1 > WIDTH && x2 > WIDTH) || (x1 < 0 && x2 < 0) ||
+       (y1 > HEIGHT && y2 > HEIGHT) || (y1 < 0 && y2 < 0))
+      return;
+
+   if (y1 == y2 && y1 >= 0) {
+      int iLeft = x1 < x2 ? x1 : x2;
+      int iLength = abs(x2 - x1) + 1;
+      Draw_blendSpan(iLeft, y1 + 1, iLength, color, alpha / 2);
+      Draw_blendSpan(iLeft, y1 - 1, iLength, color, alpha - alpha / 2);
+      if (alpha < 255)
+         Draw_blendSpan(iLeft, y1, iLength, color, alpha);
+      else
+         for (; iLength > 0; iLength--, iLeft++)
+            Draw_drawPixel(iLeft, y1, color);
+      return;
+   }
+
+   xd = x2 - x1;
+   yd = y2 - y1;
+   if (abs(xd) >= abs(yd)) {
+      xaa = 0; yaa = 1;
+      a = &x1; b = &y1; a2 = &x2;
+      db = (double)yd / xd;
+   } else {
+      xaa = 1; yaa = 0;
+      a = &y1; b = &x1; a2 = &y2;
+      db = (double)xd / yd;
+   }
+   da = (*a <= *a2) ? 1 : -1;
+   db *= da;
+   realb = (double)*b;
+   *a2 += da;
+
+   for (; *a != *a2; *a += da) {
+      *b = (int)(realb + 0.5);
+      aa = (realb + 0.5 - *b) * alpha;
+      Draw_blendPixel(x1 + xaa, y1 + yaa, color, (int)aa);
+      Draw_blendPixel(x1 - xaa, y1 - yaa, color, alpha - (int)aa);
+      if (alpha < 255)
+         Draw_blendPixel(x1, y1, color, alpha);
+      else
+         Draw_drawPixel(x1, y1, color);
+      realb += db;
+   }
+}
+
+/* Returns the seconds of processor time since iStart. */
+static double secondsSince(clock_t iStart) {
+   return (double)(clock() - iStart) / CLOCKS_PER_SEC;
+}
+
+/* Fills piLines with iNum random lines, four ints each, up to iLength
+   pixels along each axis and mostly on the screen. */
+static void makeLines(int* piLines, int iNum, int iLength) {
+   int i;
+   for (i = 0; i < iNum; i++) {
+      piLines[4 * i] = rand() % WIDTH;
+      piLines[4 * i + 1] = rand() % HEIGHT;
+      piLines[4 * i + 2] = piLines[4 * i] + rand() % (2 * iLength + 1) -
+                           iLength;
+      piLines[4 * i + 3] = piLines[4 * i + 1] + rand() % (2 * iLength + 1) -
+                           iLength;
+   }
+}
+
+/* Returns the color line i is drawn in. */
+static Color_T lineColor(int i) {
+   return (Color_T)(i * 2654435761UL & 0xFFFFFF);
+}
+
+/* Returns the alpha line i is drawn with. */
+static Uint8 lineAlpha(int i) {
+   return (Uint8)(i % 4 ? 255 : 160);
+}
+
+/* Returns the most any of the red, green and blue of uColor1 and uColor2
+   differ by. */
+static int colorDifference(Color_T uColor1, Color_T uColor2) {
+   int iMost = 0, iShift, iDiff;
+   for (iShift = 0; iShift < 24; iShift += 8) {
+      iDiff = abs((int)(uColor1 >> iShift & 0xFF) -
+                  (int)(uColor2 >> iShift & 0xFF));
+      if (iDiff > iMost)
+         iMost = iDiff;
+   }
+   return iMost;
+}
+
+/* Draws line i of piLines alone with pfLine and copies the result to
+   puFrame. */
+static void drawAlone(void (*pfLine)(int, int, int, int, Color_T, Uint8),
+                      const int* piLines, int i, Color_T* puFrame) {
+   int y;
+
+   Draw_clearScreen();
+   (*pfLine)(piLines[4 * i], piLines[4 * i + 1], piLines[4 * i + 2],
+             piLines[4 * i + 3], lineColor(i), lineAlpha(i));
+   for (y = 0; y < HEIGHT; y++)
+      memcpy(puFrame + y * WIDTH, Draw_getRow(y), WIDTH * sizeof(Color_T));
+}
+
+/* Draws the iNum lines in piLines with pfLine and returns the seconds it
+   took.  Copies the result to puFrame. */
+static double timeLines(void (*pfLine)(int, int, int, int, Color_T, Uint8),
+                        const int* piLines, int iNum, Color_T* puFrame) {
+   clock_t iStart;
+   double dSeconds;
+   int i, y;
+
+   Draw_clearScreen();
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      (*pfLine)(piLines[4 * i], piLines[4 * i + 1], piLines[4 * i + 2],
+                piLines[4 * i + 3], lineColor(i), lineAlpha(i));
+   dSeconds = secondsSince(iStart);
+
+   for (y = 0; y < HEIGHT; y++)
+      memcpy(puFrame + y * WIDTH, Draw_getRow(y), WIDTH * sizeof(Color_T));
+   return dSeconds;
+}
+
+int main(int argc, char *argv[]) {
+   static const int aiLengths[2] = { 20, 2000 };
+   int iNum = DEFAULT_NUM_LINES;
+   int* piLines;
+   Color_T *puOld, *puNew;
+   double dOld, dNew;
+   long iDiffer;
+   int iOnScreen, iOffScreen, iOffBorder, isOff, iDiff, i, j, x, y;
+   int isWrong = 0;
+
+   if (argc > 1)
+      iNum = atoi(argv[1]);
+   if (iNum < 1)
+      iNum = DEFAULT_NUM_LINES;
+
+   piLines = (int*)malloc(4 * iNum * sizeof(int));
+   puOld = (Color_T*)malloc(2 * WIDTH * HEIGHT * sizeof(Color_T));
+   if (piLines == NULL || puOld == NULL) {
+      fprintf(stderr, "Out of memory\n");
+      return 1;
+   }
+   puNew = puOld + WIDTH * HEIGHT;
+
+   Draw_initMemory(WIDTH, HEIGHT);
+   srand(1);
+   for (j = 0; j < 2; j++) {
+      makeLines(piLines, iNum, aiLengths[j]);
+      dOld = timeLines(oldLine, piLines, iNum, puOld);
+      dNew = timeLines(Draw_drawLineAlpha, piLines, iNum, puNew);
+
+      /* The lines overlap and blend, so a pixel one rounds differently
+         carries into every line drawn over it: this counts the pixels
+         that differ at all, not by how much. */
+      iDiffer = 0;
+      for (i = 0; i < WIDTH * HEIGHT; i++)
+         iDiffer += puOld[i] != puNew[i];
+
+      /* Drawn one at a time, lines wholly on the screen differ by at most
+         a level or two of rounding, and clipped ones by one more, as the
+         new code starts stepping at the edge.  Next to the edge they can
+         differ by anything: the old code rounded negative coordinates
+         toward zero, putting pixels meant for row or column -1 on 0 with
+         a negative blend. */
+      iOnScreen = iOffScreen = iOffBorder = 0;
+      for (i = 0; i < NUM_CHECKED && i < iNum; i++) {
+         isOff = piLines[4 * i + 2] < 0 || piLines[4 * i + 2] >= WIDTH ||
+                 piLines[4 * i + 3] < 0 || piLines[4 * i + 3] >= HEIGHT;
+         drawAlone(oldLine, piLines, i, puOld);
+         drawAlone(Draw_drawLineAlpha, piLines, i, puNew);
+         for (y = 0; y < HEIGHT; y++)
+            for (x = 0; x < WIDTH; x++) {
+               iDiff = colorDifference(puOld[y * WIDTH + x],
+                                       puNew[y * WIDTH + x]);
+               if (!isOff && iDiff > iOnScreen)
+                  iOnScreen = iDiff;
+               else if (isOff && iDiff > iOffScreen)
+                  iOffScreen = iDiff;
+               if (isOff && iDiff > iOffBorder && x >= BORDER &&
+                   y >= BORDER && x < WIDTH - BORDER && y < HEIGHT - BORDER)
+                  iOffBorder = iDiff;
+            }
+      }
+      if (iOnScreen > MAX_ROUNDING || iOffBorder > MAX_CLIPPED)
+         isWrong = 1;
+
+      printf("%d lines up to %d pixels long\n", iNum, aiLengths[j]);
+      printf("old rasterizer: %10.1f ns/line\n", 1e9 * dOld / iNum);
+      printf("new rasterizer: %10.1f ns/line\n", 1e9 * dNew / iNum);
+      printf("pixels that differ after all lines: %ld of %d\n", iDiffer,
+             WIDTH * HEIGHT);
+      printf("largest difference, lines on the screen:  %d\n", iOnScreen);
+      printf("largest difference, lines off the screen: %d, %d more than "
+             "%d pixels from the edge\n", iOffScreen, iOffBorder, BORDER);
+   }
+
+   free(piLines);
+   free(puOld);
+   return isWrong;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: bench_neighbors.c is a micro-benchmark comparing the grid's
+ *    radius and nearest neighbour queries with scanning every object, on
+ *    random ship-sized circles.  Every object asks once, as an AI tick
+ *    would.  Run it as: ./bench_neighbors [number of objects]
+ ___________________________________________________________________________*/
+
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define DEFAULT_NUM_OBJECTS 4000
+#define CELL_SIZE 512      /* As the ships' broad phase uses. */
+#define SPACING 1000       /* Roughly how far apart objects are. */
+#define RANGE 2000         /* How far the queries look. */
+#define K 8                /* How many nearest neighbours are asked for. */
+
+/* What each object is. */
+struct Object {
+       double dX;
+       double dY;
+       };
+
+/* Counts what Grid_mapWithin finds into the long pvCount points to. */
+static void countFound(void* pvItem, double dDistance, void* pvCount) {
+   (*(long*)pvCount)++;
+}
+
+/* Puts the distances to the K objects of the iNum in poObjects nearest
+   object i, nearest first, in pdBest, by looking at every one.  Places
+   with nothing within RANGE are left further than RANGE. */
+static void scanNearest(struct Object* poObjects, int iNum, int i,
+                        double* pdBest) {
+   double dDX, dDY, dDistance;
+   int j, k;
+
+   for (k = 0; k < K; k++)
+      pdBest[k] = RANGE + 1;
+   for (j = 0; j < iNum; j++) {
+      if (j == i)
+         continue;
+      dDX = poObjects[j].dX - poObjects[i].dX;
+      dDY = poObjects[j].dY - poObjects[i].dY;
+      dDistance = sqrt(dDX * dDX + dDY * dDY);
+      for (k = K - 1; k >= 0 && pdBest[k] > dDistance; k--)
+         if (k < K - 1)
+            pdBest[k + 1] = pdBest[k];
+      if (k < K - 1)
+         pdBest[k + 1] = dDistance;
+   }
+}
+
+/* Returns a random double in [dMin, dMax). */
+static double randRange(double dMin, double dMax) {
+   return dMin + (dMax - dMin) * (rand() / (RAND_MAX + 1.0));
+}
+
+/* Returns the seconds of processor time since iStart. */
+static double secondsSince(clock_t iStart) {
+   return (double)(clock() - iStart) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+   int iNum = DEFAULT_NUM_OBJECTS;
+   struct Object* poObjects;
+   Grid_T oGrid;
+   void* apvNearest[K];
+   double adNearest[K], adBrute[K];
+   double dSide, dDX, dDY;
+   double dBruteWithin, dGridWithin, dBruteNearest, dGridNearest;
+   long iBruteFound = 0, iGridFound = 0, iDiffer = 0;
+   clock_t iStart;
+   int iFound, i, j, k;
+
+   if (argc > 1)
+      iNum = atoi(argv[1]);
+   if (iNum < 1)
+      iNum = DEFAULT_NUM_OBJECTS;
+
+   poObjects = (struct Object*)malloc(iNum * sizeof(struct Object));
+   if (poObjects == NULL) {
+      fprintf(stderr, "Out of memory\n");
+      return 1;
+   }
+
+   /* Spread the objects out evenly enough that each has a handful of
+      others in range, as a fleet would. */
+   srand(1);
+   dSide = sqrt((double)iNum) * SPACING;
+   oGrid = Grid_new(CELL_SIZE);
+   for (i = 0; i < iNum; i++) {
+      poObjects[i].dX = randRange(0, dSide);
+      poObjects[i].dY = randRange(0, dSide);
+      Grid_insert(oGrid, &poObjects[i], poObjects[i].dX, poObjects[i].dY,
+                  randRange(100, 300));
+   }
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      for (j = 0; j < iNum; j++) {
+         dDX = poObjects[j].dX - poObjects[i].dX;
+         dDY = poObjects[j].dY - poObjects[i].dY;
+         if (dDX * dDX + dDY * dDY <= (double)RANGE * RANGE)
+            iBruteFound++;
+      }
+   dBruteWithin = secondsSince(iStart);
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      Grid_mapWithin(oGrid, poObjects[i].dX, poObjects[i].dY, RANGE,
+                     countFound, &iGridFound);
+   dGridWithin = secondsSince(iStart);
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      scanNearest(poObjects, iNum, i, adBrute);
+   dBruteNearest = secondsSince(iStart);
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      Grid_findNearest(oGrid, poObjects[i].dX, poObjects[i].dY, RANGE,
+                       &poObjects[i], K, apvNearest, adNearest);
+   dGridNearest = secondsSince(iStart);
+
+   /* Check the nearest neighbours against scanning, for every object. */
+   for (i = 0; i < iNum; i++) {
+      scanNearest(poObjects, iNum, i, adBrute);
+      iFound = Grid_findNearest(oGrid, poObjects[i].dX, poObjects[i].dY,
+                                RANGE, &poObjects[i], K, apvNearest,
+                                adNearest);
+      for (k = 0; k < K; k++)
+         if ((k < iFound) != (adBrute[k] <= RANGE) ||
+             (k < iFound && adNearest[k] != adBrute[k]))
+            iDiffer++;
+   }
+
+   printf("%d objects, range %d, %d nearest\n", iNum, RANGE, K);
+   printf("within, scanning: %8.3f ms (%ld found)\n", dBruteWithin * 1000,
+          iBruteFound);
+   printf("within, grid:     %8.3f ms (%ld found)\n", dGridWithin * 1000,
+          iGridFound);
+   printf("nearest, scanning:%8.3f ms\n", dBruteNearest * 1000);
+   printf("nearest, grid:    %8.3f ms (%ld differ)\n", dGridNearest * 1000,
+          iDiffer);
+
+   Grid_free(oGrid);
+   free(poObjects);
+   return iBruteFound != iGridFound || iDiffer != 0;
+}
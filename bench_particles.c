@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: bench_particles.c is a micro-benchmark comparing the
+ *    struct of arrays particle system in particlesys.c with the interleaved
+ *    one it replaced, adding and drawing a large system every frame.
+ *    Run it as: ./bench_particles [particles [frames]]
+ *    It opens a window; set SDL_VIDEODRIVER=dummy to run without a display.
+ ___________________________________________________________________________*/
+
+#include "draw.h"
+#include "particlesys.h"
+#include "render.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_NUM_PARTICLES 100000
+#define DEFAULT_NUM_FRAMES 100
+#define SPAWN_FRACTION 10 /* One particle in this many is new each frame. */
+#define LIFETIME 1e9      /* Never expire, as the old system could not. */
+
+/* The old system: interleaved doubles, with a random particle replaced
+   once it is full. */
+struct OldParticleSys {
+       double* pdPointArray;
+       int iNum;
+       int iNumUsed;
+       Color_T iColor;
+       };
+
+/* The old ParticleSys_add, as it was. */
+static void oldAdd(struct OldParticleSys* oPSys, double dX, double dY) {
+   int pos;
+
+   if(oPSys->iNumUsed < oPSys->iNum) {
+      oPSys->pdPointArray[2 * oPSys->iNumUsed] = dX;
+      oPSys->pdPointArray[2 * oPSys->iNumUsed + 1] = dY;
+      oPSys->iNumUsed++;
+      return;
+   }
+   pos = (int)((double)rand() / (RAND_MAX) * oPSys->iNum);
+   oPSys->pdPointArray[2 * pos] = dX;
+   oPSys->pdPointArray[2 * pos + 1] = dY;
+}
+
+/* The old ParticleSys_draw, as it was. */
+static void oldDraw(struct OldParticleSys* oPSys) {
+   int i;
+   for(i = 0; i < oPSys->iNumUsed; i++) {
+      Draw_drawScaledPixel(oPSys->pdPointArray[2 * i],
+                           oPSys->pdPointArray[2 * i + 1], oPSys->iColor);
+   }
+}
+
+/* Returns the seconds of processor time since iStart. */
+static double secondsSince(clock_t iStart) {
+   return (double)(clock() - iStart) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+   int iNum = DEFAULT_NUM_PARTICLES, iFrames = DEFAULT_NUM_FRAMES;
+   int iSpawn, iNext, i, f;
+   struct OldParticleSys oOld;
+   ParticleSys_T oNew;
+   double* pdSpawn;
+   Color_T iWhite;
+   Rng_T oRng;
+   clock_t iStart;
+   double dOld, dNew;
+   long lDrawn;
+   int iResult;
+
+   if (argc > 1)
+      iNum = atoi(argv[1]);
+   if (argc > 2)
+      iFrames = atoi(argv[2]);
+   if (iNum < SPAWN_FRACTION)
+      iNum = DEFAULT_NUM_PARTICLES;
+   if (iFrames < 1)
+      iFrames = DEFAULT_NUM_FRAMES;
+   iSpawn = iNum / SPAWN_FRACTION;
+
+   Draw_init();
+   iWhite = Draw_getColor((char)255, (char)255, (char)255);
+
+   /* Spawn points over and around the screen, made up front so neither
+      system pays for them. */
+   pdSpawn = (double*)malloc(2 * (iNum + iSpawn * iFrames) * sizeof(double));
+   oOld.pdPointArray = (double*)malloc(2 * iNum * sizeof(double));
+   if (pdSpawn == NULL || oOld.pdPointArray == NULL) {
+      fprintf(stderr, "Out of memory\n");
+      return 1;
+   }
+   oRng = Rng_make(1);
+   for (i = 0; i < 2 * (iNum + iSpawn * iFrames); i += 2) {
+      pdSpawn[i] = 1000 * (Rng_uniform(&oRng) - 0.5);
+      pdSpawn[i + 1] = 800 * (Rng_uniform(&oRng) - 0.5);
+   }
+   oOld.iNum = iNum;
+   oOld.iNumUsed = 0;
+   oOld.iColor = iWhite;
+   oNew = ParticleSys_new(iNum, iWhite, LIFETIME);
+
+   /* Fill both systems, then each frame add some and draw them all. */
+   for (i = 0; i < iNum; i++) {
+      oldAdd(&oOld, pdSpawn[2 * i], pdSpawn[2 * i + 1]);
+      ParticleSys_add(oNew, pdSpawn[2 * i], pdSpawn[2 * i + 1], 1, -1);
+   }
+
+   Draw_lockScreen();
+   iStart = clock();
+   for (f = 0, iNext = iNum; f < iFrames; f++) {
+      for (i = 0; i < iSpawn; i++, iNext++)
+         oldAdd(&oOld, pdSpawn[2 * iNext], pdSpawn[2 * iNext + 1]);
+      oldDraw(&oOld);
+   }
+   dOld = secondsSince(iStart);
+
+   iStart = clock();
+   for (f = 0, iNext = iNum; f < iFrames; f++) {
+      for (i = 0; i < iSpawn; i++, iNext++)
+         ParticleSys_add(oNew, pdSpawn[2 * iNext], pdSpawn[2 * iNext + 1],
+                         1, -1);
+      ParticleSys_update(oNew, 0.1);
+      ParticleSys_draw(oNew);
+      Render_flush();
+   }
+   dNew = secondsSince(iStart);
+   Draw_unlockScreen();
+
+   lDrawn = (long)iNum * iFrames;
+   printf("%d particles, %d added per frame, %d frames\n", iNum, iSpawn,
+          iFrames);
+   printf("old add and draw:         %8.2f ns/particle, %8.2f ms/frame\n",
+          1e9 * dOld / lDrawn, 1e3 * dOld / iFrames);
+   printf("new add, update and draw: %8.2f ns/particle, %8.2f ms/frame\n",
+          1e9 * dNew / lDrawn, 1e3 * dNew / iFrames);
+
+   /* Neither system should have lost any particles. */
+   iResult = ParticleSys_getCount(oNew) != iNum || oOld.iNumUsed != iNum;
+
+   free(pdSpawn);
+   free(oOld.pdPointArray);
+   ParticleSys_free(oNew);
+
+   return iResult;
+}
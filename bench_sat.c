@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: bench_sat.c is a micro-benchmark comparing the packed
+ *    separating axis test in sat.c with the allocating Vector_T version
+ *    that Rect_doIntersect used to be, on random pairs of rects.
+ *    Run it as: ./bench_sat [number of rects]
+ ___________________________________________________________________________*/
+
+#include "sat.h"
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define DEFAULT_NUM_RECTS 2000
+#define PI 3.14159265358979
+
+/* A rect the way the old test wanted it: every vector on the heap. */
+struct OldRect {
+       double extentX;
+       double extentY;
+       Vector_T center;
+       Vector_T axisX;
+       Vector_T axisY;
+       };
+
+/* The old Rect_doIntersect, kept as it was apart from taking the center of
+   the rect directly rather than as object center plus offset. */
+static int oldIntersect(struct OldRect* oRect1, struct OldRect* oRect2) {
+   Vector_T T, L;
+   double R1, R2, scale;
+   Vector_T aoAxes[4];
+   int i;
+
+   T = Vector_diff(oRect2->center, oRect1->center);
+   scale = Vector_length(T);
+   aoAxes[0] = oRect1->axisX;
+   aoAxes[1] = oRect1->axisY;
+   aoAxes[2] = oRect2->axisX;
+   aoAxes[3] = oRect2->axisY;
+
+   for (i = 0; i < 4; i++) {
+      L = Vector_copy(aoAxes[i]);
+      Vector_scale(L, scale);
+      R1 = oRect1->extentX * abs(Vector_dot(oRect1->axisX, L)) +
+           oRect1->extentY * abs(Vector_dot(oRect1->axisY, L));
+      R2 = oRect2->extentX * abs(Vector_dot(oRect2->axisX, L)) +
+           oRect2->extentY * abs(Vector_dot(oRect2->axisY, L));
+      if (abs(Vector_dot(T, L)) > R1 + R2) {
+         Vector_free(L);
+         Vector_free(T);
+         return 0;
+      }
+      Vector_free(L);
+   }
+   Vector_free(T);
+   return 1;
+}
+
+/* Returns a random double in [dMin, dMax). */
+static double randRange(double dMin, double dMax) {
+   return dMin + (dMax - dMin) * (rand() / (RAND_MAX + 1.0));
+}
+
+/* Returns the seconds of processor time since iStart. */
+static double secondsSince(clock_t iStart) {
+   return (double)(clock() - iStart) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+   int iNum = DEFAULT_NUM_RECTS;
+   struct OldRect* poOld;
+   double* pdPacked;
+   double *pdCX, *pdCY, *pdAX, *pdAY, *pdEX, *pdEY;
+   unsigned char* pcResult;
+   SatBoxes_T oBoxes;
+   double dTheta;
+   long iPairs, iOldHits = 0, iHits = 0, iManyHits = 0, iDiffer = 0;
+   clock_t iStart;
+   double dOld, dNew, dMany;
+   int iMismatch = -1, i, j;
+
+   if (argc > 1)
+      iNum = atoi(argv[1]);
+   if (iNum < 1)
+      iNum = DEFAULT_NUM_RECTS;
+   iPairs = (long)iNum * iNum;
+
+   poOld = (struct OldRect*)malloc(iNum * sizeof(struct OldRect));
+   pdPacked = (double*)malloc(iNum * SAT_BOX_SIZE * sizeof(double));
+   pdCX = (double*)malloc(6 * iNum * sizeof(double));
+   pcResult = (unsigned char*)malloc(iNum);
+   if (poOld == NULL || pdPacked == NULL || pdCX == NULL || pcResult == NULL) {
+      fprintf(stderr, "Out of memory\n");
+      return 1;
+   }
+   pdCY = pdCX + iNum;
+   pdAX = pdCY + iNum;
+   pdAY = pdAX + iNum;
+   pdEX = pdAY + iNum;
+   pdEY = pdEX + iNum;
+
+   /* Random rects about the size of ship parts, in an area about the size
+      of a ship, so a fair share of pairs overlap. */
+   srand(1);
+   for (i = 0; i < iNum; i++) {
+      dTheta = randRange(0, 2 * PI);
+      pdCX[i] = randRange(-200, 200);
+      pdCY[i] = randRange(-200, 200);
+      pdAX[i] = cos(dTheta);
+      pdAY[i] = sin(dTheta);
+      pdEX[i] = randRange(1, 40);
+      pdEY[i] = randRange(1, 40);
+
+      pdPacked[i * SAT_BOX_SIZE + SAT_CENTER_X] = pdCX[i];
+      pdPacked[i * SAT_BOX_SIZE + SAT_CENTER_Y] = pdCY[i];
+      pdPacked[i * SAT_BOX_SIZE + SAT_AXIS_X] = pdAX[i];
+      pdPacked[i * SAT_BOX_SIZE + SAT_AXIS_Y] = pdAY[i];
+      pdPacked[i * SAT_BOX_SIZE + SAT_EXTENT_X] = pdEX[i];
+      pdPacked[i * SAT_BOX_SIZE + SAT_EXTENT_Y] = pdEY[i];
+
+      poOld[i].extentX = pdEX[i];
+      poOld[i].extentY = pdEY[i];
+      poOld[i].center = Vector_new(pdCX[i], pdCY[i]);
+      poOld[i].axisX = Vector_new(pdAX[i], pdAY[i]);
+      poOld[i].axisY = Vector_new(-pdAY[i], pdAX[i]);
+   }
+   oBoxes.pdCenterX = pdCX;
+   oBoxes.pdCenterY = pdCY;
+   oBoxes.pdAxisX = pdAX;
+   oBoxes.pdAxisY = pdAY;
+   oBoxes.pdExtentX = pdEX;
+   oBoxes.pdExtentY = pdEY;
+   oBoxes.iCount = iNum;
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      for (j = 0; j < iNum; j++)
+         iOldHits += oldIntersect(&poOld[i], &poOld[j]);
+   dOld = secondsSince(iStart);
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      for (j = 0; j < iNum; j++)
+         iHits += Sat_overlap(pdPacked + i * SAT_BOX_SIZE,
+                              pdPacked + j * SAT_BOX_SIZE);
+   dNew = secondsSince(iStart);
+
+   iStart = clock();
+   for (i = 0; i < iNum; i++)
+      iManyHits += Sat_overlapMany(pdPacked + i * SAT_BOX_SIZE, &oBoxes,
+                                   pcResult);
+   dMany = secondsSince(iStart);
+
+   /* The old test rounds its projections to integers with abs(), so it is
+      expected to disagree now and then. */
+   for (i = 0; i < iNum; i++)
+      for (j = 0; j < iNum; j++)
+         iDiffer += oldIntersect(&poOld[i], &poOld[j]) !=
+                    Sat_overlap(pdPacked + i * SAT_BOX_SIZE,
+                                pdPacked + j * SAT_BOX_SIZE);
+
+   printf("%ld pairs of rects\n", iPairs);
+   printf("old Rect_doIntersect: %8.2f ns/pair, %ld overlapping\n",
+          1e9 * dOld / iPairs, iOldHits);
+   printf("Sat_overlap:          %8.2f ns/pair, %ld overlapping\n",
+          1e9 * dNew / iPairs, iHits);
+   printf("Sat_overlapMany:      %8.2f ns/pair, %ld overlapping\n",
+          1e9 * dMany / iPairs, iManyHits);
+   printf("old and new disagree on %ld pairs\n", iDiffer);
+
+   /* The batched test must agree with the single one on every pair, not
+      just on how many overlap. */
+   for (i = 0; i < iNum && iMismatch < 0; i++) {
+      Sat_overlapMany(pdPacked + i * SAT_BOX_SIZE, &oBoxes, pcResult);
+      for (j = 0; j < iNum; j++) {
+         if (pcResult[j] != Sat_overlap(pdPacked + i * SAT_BOX_SIZE,
+                                        pdPacked + j * SAT_BOX_SIZE)) {
+            printf("Sat_overlapMany is wrong for rects %d and %d\n", i, j);
+            iMismatch = i;
+            break;
+         }
+      }
+   }
+
+   for (i = 0; i < iNum; i++) {
+      Vector_free(poOld[i].center);
+      Vector_free(poOld[i].axisX);
+      Vector_free(poOld[i].axisY);
+   }
+   free(poOld);
+   free(pdPacked);
+   free(pdCX);
+   free(pcResult);
+
+   return iMismatch >= 0;
+}
@@ -33,26 +33,156 @@
 #include <SDL.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 
-#define XRES 800
-#define YRES 600
-#define DEPTH 32
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-/* State variables of the draw interface. */
+#define DEFAULT_WIDTH 800
+#define DEFAULT_HEIGHT 600
+#define DEFAULT_DEPTH 32
+#define PIXEL_BATCH 256 /* Points projected at a time. */
+#define VISIBLE_MARGIN 2 /* Pixels a line's anti-aliasing may stray. */
+#define MAX_SIZE 16384   /* Widest or tallest that lines can be drawn on. */
+#define LINE_BIAS 4      /* Pixels added to keep fixed point positive. */
+#define LINE_RUN_SLOPE 16384 /* Steepest slope, 16.16, drawn a run at a time. */
+#define DIRTY_SIZE 64    /* Pixels on a side of a square tracked for redraw. */
+
+/* State variables of the draw interface.  Everything is drawn on oTarget,
+   iWidth by iHeight 32 bit pixels.  That is the screen itself unless the
+   screen has another depth or is drawn at a lower resolution, when it is a
+   buffer copied to the screen, iUpscale times larger, on each flip.  With
+   no screen at all, oTarget is only ever read back by the caller. */
 static SDL_Surface* oScreen;
+static SDL_Surface* oTarget;
+static SDL_Surface* oStaging; /* Full size 32 bit copy for other depths. */
+static int iWidth;
+static int iHeight;
+static int iUpscale;
+static DrawClip_T oScreenClip;
+static double dResolution; /* Pixels per pixel of the default screen. */
+static int iHeadless; /* Initialized without a screen; draw nothing. */
 static Color_T iClearColor;
-static double dScaleX;
-static double dScaleY;
-static double dShiftX;
-static double dShiftY;
 
-/* Initialize the drawing module.  It is a checked runtime error for the
-   drawing module to be previously initialized. */
+/* Where has been drawn on, in DIRTY_SIZE squares, so that clearing and
+   presenting touch only what changed.  Each square holds the last frame
+   drawn in it, frames being counted by Draw_clearScreen; every square
+   starts out drawn in frame 0, so the first frames redo everything. */
+static int* piDrawn;
+static int iCellsX;
+static int iCellsY;
+static int iFrame;
+static SDL_Rect* poDirty; /* Room for a rectangle per square. */
+static DrawView_T oView;
+
+/* The screen's pitch in pixels and its color masks, kept from Draw_init so
+   blending need not look them up for every pixel. */
+static int iPitch;
+static Uint32 iRmask;
+static Uint32 iGmask;
+static Uint32 iBmask;
+
+/* Blends color into iDst by alpha, for the screen's format.  Picked once by
+   Draw_init. */
+static Uint32 (*pfBlend)(Uint32 iDst, Color_T color, Uint32 alpha);
+static int iPackedFormat; /* pfBlend is Draw_blendPacked. */
+
+/* In house function for blending in any 32 bit format with channels of at
+   most eight bits, one channel at a time. */
+static Uint32 Draw_blendMasked(Uint32 iDst, Color_T color, Uint32 alpha) {
+   Uint32 R, G, B;
+   R = ((iDst & iRmask) + (((color & iRmask) - (iDst & iRmask)) * alpha >> 8)) & iRmask;
+   G = ((iDst & iGmask) + (((color & iGmask) - (iDst & iGmask)) * alpha >> 8)) & iGmask;
+   B = ((iDst & iBmask) + (((color & iBmask) - (iDst & iBmask)) * alpha >> 8)) & iBmask;
+   return R | G | B;
+}
+
+/* In house function for blending when red and blue are the low and third
+   bytes, either way round, and green is the second.  Red and blue are
+   far enough apart to share a multiply, and come out exactly as they would
+   from Draw_blendMasked. */
+static Uint32 Draw_blendPacked(Uint32 iDst, Color_T color, Uint32 alpha) {
+   Uint32 RB, G;
+   RB = iDst & 0xFF00FF;
+   G = iDst & 0x00FF00;
+   RB = (RB + (((color & 0xFF00FF) - RB) * alpha >> 8)) & 0xFF00FF;
+   G = (G + (((color & 0x00FF00) - G) * alpha >> 8)) & 0x00FF00;
+   return RB | G;
+}
+
+/* In house function for picking the blend for the screen's format. */
+static void Draw_initBlend() {
+   iPitch = oTarget->pitch / 4;
+   iRmask = oTarget->format->Rmask;
+   iGmask = oTarget->format->Gmask;
+   iBmask = oTarget->format->Bmask;
+   iPackedFormat = iGmask == 0x00FF00 && (iRmask | iBmask) == 0xFF00FF;
+   pfBlend = iPackedFormat ? Draw_blendPacked : Draw_blendMasked;
+}
+
+/* In house function for setting the size of what is drawn on to iNewWidth
+   by iNewHeight, and the scale the default screen would have. */
+static void Draw_setSize(int iNewWidth, int iNewHeight) {
+   double dResolutionY;
+
+   assert(iNewWidth <= MAX_SIZE && iNewHeight <= MAX_SIZE);
+   iWidth = iNewWidth;
+   iHeight = iNewHeight;
+   oScreenClip.iLeft = oScreenClip.iTop = 0;
+   oScreenClip.iRight = iWidth;
+   oScreenClip.iBottom = iHeight;
+
+   iCellsX = (iWidth + DIRTY_SIZE - 1) / DIRTY_SIZE;
+   iCellsY = (iHeight + DIRTY_SIZE - 1) / DIRTY_SIZE;
+   piDrawn = (int*)calloc(iCellsX * iCellsY, sizeof(int));
+   poDirty = (SDL_Rect*)malloc(iCellsX * iCellsY * sizeof(SDL_Rect));
+   assert(piDrawn != NULL && poDirty != NULL);
+
+   /* Keep the whole of the default view in sight at any shape. */
+   dResolution = (double)iWidth / DEFAULT_WIDTH;
+   dResolutionY = (double)iHeight / DEFAULT_HEIGHT;
+   if (dResolutionY < dResolution)
+      dResolution = dResolutionY;
+}
+
+/* In house function for making a 32 bit surface iW by iH in the layout
+   Draw_blendPacked is fastest with, or exiting if it cannot. */
+static SDL_Surface* Draw_newSurface(int iW, int iH) {
+   SDL_Surface* oSurface = SDL_CreateRGBSurface(SDL_SWSURFACE, iW, iH, 32,
+                                                0xFF0000, 0x00FF00, 0x0000FF,
+                                                0);
+   if (oSurface == NULL) {
+      fprintf(stderr, "Unable to make a %dx%d buffer: %s\n", iW, iH,
+              SDL_GetError());
+      exit(1);
+   }
+   return oSurface;
+}
+
+/* Initialize the drawing module at the default screen size and depth.  It is
+   a checked runtime error for the drawing module to be previously
+   initialized. */
 void Draw_init() {
+   Draw_initMode(DEFAULT_WIDTH, DEFAULT_HEIGHT, DEFAULT_DEPTH, 1);
+}
+
+/* Initialize the drawing module with an iScreenWidth by iScreenHeight screen
+   of iDepth bits per pixel, drawn at 1 / iDownscale of that size and scaled
+   up to fill it.  Scales set by the other functions are in pixels of the
+   default 800 by 600 screen, so every mode shows the same part of the
+   world.  It is a checked runtime error for the drawing module to be
+   previously initialized, for either size not to be positive, for
+   iDownscale not to be positive, or for either size drawn at to be over
+   16384 pixels. */
+void Draw_initMode(int iScreenWidth, int iScreenHeight, int iDepth,
+                   int iDownscale) {
 
    /* Initialize SDL. */
-   assert(oScreen == NULL);
+   assert(oTarget == NULL && !iHeadless);
+   assert(iScreenWidth > 0 && iScreenHeight > 0 && iDownscale > 0);
    if (SDL_Init(SDL_INIT_AUDIO|SDL_INIT_VIDEO) < 0) {
       fprintf(stderr, "Unable to init SDL: %s\n", SDL_GetError());
       exit(1);
@@ -60,62 +190,245 @@ void Draw_init() {
    atexit(SDL_Quit);
 
    /* Set the screen. */
-   oScreen = SDL_SetVideoMode(XRES, YRES, DEPTH, SDL_HWSURFACE|SDL_DOUBLEBUF);
+   oScreen = SDL_SetVideoMode(iScreenWidth, iScreenHeight, iDepth,
+                              SDL_HWSURFACE|SDL_DOUBLEBUF);
    if (oScreen == NULL) {
-      fprintf(stderr, "Unable to set 640x480 video: %s\n", SDL_GetError());
+      fprintf(stderr, "Unable to set %dx%dx%d video: %s\n", iScreenWidth,
+              iScreenHeight, iDepth, SDL_GetError());
       exit(1);
    }
 
+   /* Draw on the screen when it can be, or on a buffer otherwise. */
+   iUpscale = iDownscale;
+   Draw_setSize(iScreenWidth / iUpscale > 0 ? iScreenWidth / iUpscale : 1,
+                iScreenHeight / iUpscale > 0 ? iScreenHeight / iUpscale : 1);
+   if (iUpscale == 1 && oScreen->format->BytesPerPixel == 4)
+      oTarget = oScreen;
+   else
+      oTarget = Draw_newSurface(iWidth, iHeight);
+   if (iUpscale > 1 && oScreen->format->BytesPerPixel != 4)
+      oStaging = Draw_newSurface(iScreenWidth, iScreenHeight);
+   Draw_initBlend();
+
    /* Set the initial scaling and shifting factors. */
-   dScaleX = 1.0;
-   dScaleY = 1.0;
-   dShiftX = 0.0;
-   dShiftY = 0.0;
+   oView.dScaleX = dResolution;
+   oView.dScaleY = dResolution;
+   oView.dShiftX = 0.0;
+   oView.dShiftY = 0.0;
 
    /* Set the background color to black. */
    iClearColor = Draw_getColor(0, 0, 0);
 }
 
+/* Initialize the drawing module without a screen.  SDL video is never
+   touched and every drawing call is dropped, so the simulation can run on
+   machines with no display.  It is a checked runtime error for the drawing
+   module to be previously initialized. */
+void Draw_initHeadless() {
+   assert(oTarget == NULL && !iHeadless);
+   iHeadless = 1;
+   Draw_setSize(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+
+   oView.dScaleX = 1.0;
+   oView.dScaleY = 1.0;
+   oView.dShiftX = 0.0;
+   oView.dShiftY = 0.0;
+
+   iClearColor = Draw_getColor(0, 0, 0);
+}
+
+/* Initialize the drawing module to draw on an iNewWidth by iNewHeight
+   buffer in memory instead of a screen.  No window is opened and flipping
+   does nothing; Draw_getRow reads back what was drawn.  It is a checked
+   runtime error for the drawing module to be previously initialized or for
+   either size not to be from 1 to 16384 pixels. */
+void Draw_initMemory(int iNewWidth, int iNewHeight) {
+   assert(oTarget == NULL && !iHeadless);
+   assert(iNewWidth > 0 && iNewHeight > 0);
+
+   Draw_setSize(iNewWidth, iNewHeight);
+   oTarget = Draw_newSurface(iWidth, iHeight);
+   Draw_initBlend();
+
+   oView.dScaleX = dResolution;
+   oView.dScaleY = dResolution;
+   oView.dShiftX = 0.0;
+   oView.dShiftY = 0.0;
+
+   iClearColor = Draw_getColor(0, 0, 0);
+}
+
+/* Return 1 if the drawing module was initialized without a screen, and zero
+   otherwise. */
+int Draw_isHeadless() {
+   return iHeadless;
+}
+
+/* Return the width in pixels of what is drawn on, which is narrower than
+   the screen if it is drawn at a lower resolution. */
+int Draw_getWidth() {
+   return iWidth;
+}
+
+/* Return the height in pixels of what is drawn on, which is shorter than
+   the screen if it is drawn at a lower resolution. */
+int Draw_getHeight() {
+   return iHeight;
+}
+
+/* In house function for marking the pixels from iLeft to iRight and from
+   iTop to iBottom, not counting the right and bottom ones, as drawn on
+   this frame. */
+static void Draw_markBox(int iLeft, int iTop, int iRight, int iBottom) {
+   int i, j;
+
+   if (iLeft >= iWidth || iTop >= iHeight || iRight <= 0 || iBottom <= 0 ||
+       iLeft >= iRight || iTop >= iBottom)
+      return;
+   iLeft = iLeft < 0 ? 0 : iLeft / DIRTY_SIZE;
+   iTop = iTop < 0 ? 0 : iTop / DIRTY_SIZE;
+   iRight = iRight >= iWidth ? iCellsX : (iRight + DIRTY_SIZE - 1) / DIRTY_SIZE;
+   iBottom = iBottom >= iHeight ? iCellsY
+                                : (iBottom + DIRTY_SIZE - 1) / DIRTY_SIZE;
+   for (j = iTop; j < iBottom; j++)
+      for (i = iLeft; i < iRight; i++)
+         piDrawn[j * iCellsX + i] = iFrame;
+}
+
+/* Mark the iW by iH pixels from (x, y) as drawn on this frame, so that
+   they are cleared and presented.  The drawing functions that draw on the
+   whole screen mark what they draw themselves; Draw_drawPixel and
+   Draw_drawScaledLineClipped leave it to their callers.  It is a checked
+   runtime error for the drawing module to be uninitialized. */
+void Draw_markDirty(int x, int y, int iW, int iH) {
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   Draw_markBox(x, y, x + iW, y + iH);
+}
+
+/* In house function for marking pixel x, y, which must be on the screen,
+   as drawn on this frame. */
+static void Draw_markPixel(int x, int y) {
+   piDrawn[(y / DIRTY_SIZE) * iCellsX + x / DIRTY_SIZE] = iFrame;
+}
+
 /* Draw a pixel at pixel (x, y) onto the screen, with color R, G, B.
    It is a checked runtime error for for the drawing module to be
    uninitialized. */
 void Draw_drawPixel(int x, int y, Color_T color) {
    Uint32 *bufp;
 
-   assert(oScreen != NULL);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
 
    /* Make sure the position is sane. */
-   if (x < 0 || x >= XRES || y < 0 || y >= YRES)
+   if (x < 0 || x >= iWidth || y < 0 || y >= iHeight)
       return;
 
-   bufp = (Uint32 *)oScreen->pixels + y*oScreen->pitch/4 + x;
+   bufp = (Uint32 *)oTarget->pixels + y*oTarget->pitch/4 + x;
    *bufp = color;
 }
 
 /* In house function for getting a pixel at position (x, y).  It is a checked
    runtime error for the drawing module to be uninitialized. */
 Uint8* Draw_getPixel(int x, int y) {
-   assert(oScreen != NULL);
+   assert(oTarget != NULL || iHeadless);
 
-	if (x < 0 || x >= XRES || y < 0 || y >= YRES)
+	if (iHeadless || x < 0 || x >= iWidth || y < 0 || y >= iHeight)
       return 0;
-	return (Uint8*)oScreen->pixels + y * oScreen->pitch + x * 4;
+	return (Uint8*)oTarget->pixels + y * oTarget->pitch + x * 4;
+}
+
+/* In house function for drawing pixel x, y if it is inside poClip. */
+static void Draw_plotClipped(int x, int y, Color_T color,
+                             const DrawClip_T* poClip) {
+   if (x < poClip->iLeft || x >= poClip->iRight ||
+       y < poClip->iTop || y >= poClip->iBottom)
+      return;
+   ((Uint32*)oTarget->pixels)[y * iPitch + x] = color;
+}
+
+/* In house function for blending pixel x, y by alpha if it is inside
+   poClip. */
+static void Draw_blendClipped(int x, int y, Color_T color, Uint8 alpha,
+                              const DrawClip_T* poClip) {
+   Uint32* p;
+   if (x < poClip->iLeft || x >= poClip->iRight ||
+       y < poClip->iTop || y >= poClip->iBottom)
+      return;
+   p = (Uint32*)oTarget->pixels + y * iPitch + x;
+   *p = (*pfBlend)(*p, color, alpha);
 }
 
 /* Blends pixel x, y onto oScreen according to alpha.  It is a checked runtime
-   error for oScreen to be NULL. */
+   error for the drawing module to be uninitialized. */
 void Draw_blendPixel(int x, int y, Color_T color, Uint8 alpha) {
-	Uint8 *p;
-	Uint32 R, G, B;
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   if (x >= 0 && x < iWidth && y >= 0 && y < iHeight)
+      Draw_markPixel(x, y);
+   Draw_blendClipped(x, y, color, alpha, &oScreenClip);
+}
 
-	assert(oScreen != NULL);
+/* In house function for blending the part of a span inside poClip. */
+static void Draw_blendSpanClipped(int x, int y, int iLength, Color_T color,
+                                  Uint8 alpha, const DrawClip_T* poClip) {
+   Uint32* p;
+   int i = 0;
 
-	if ((p = Draw_getPixel(x, y))) {
-			R = ((*(Uint32*)p & oScreen->format->Rmask) + (((color & oScreen->format->Rmask) - (*(Uint32*)p & oScreen->format->Rmask)) * alpha >> 8) ) & oScreen->format->Rmask;
-			G = ((*(Uint32*)p & oScreen->format->Gmask) + (((color & oScreen->format->Gmask) - (*(Uint32*)p & oScreen->format->Gmask)) * alpha >> 8) ) & oScreen->format->Gmask;
-			B = ((*(Uint32*)p & oScreen->format->Bmask) + (((color & oScreen->format->Bmask) - (*(Uint32*)p & oScreen->format->Bmask)) * alpha >> 8) ) & oScreen->format->Bmask;
-			*(Uint32*)p = R | G | B;
-	}
+   if (y < poClip->iTop || y >= poClip->iBottom)
+      return;
+   if (x < poClip->iLeft) {
+      iLength -= poClip->iLeft - x;
+      x = poClip->iLeft;
+   }
+   if (x + iLength > poClip->iRight)
+      iLength = poClip->iRight - x;
+   if (iLength <= 0)
+      return;
+
+   p = (Uint32*)oTarget->pixels + y * iPitch + x;
+#if defined(__SSE2__)
+   /* Four pixels at a time, each channel widened to 16 bits.  Computing
+      (dst * (256 - alpha) + color * alpha) >> 8 stays inside 16 bits and
+      rounds just as the scalar blends do. */
+   if (iPackedFormat) {
+      __m128i vZero = _mm_setzero_si128();
+      __m128i vMask = _mm_set1_epi32((int)(iRmask | iGmask | iBmask));
+      __m128i vInvAlpha = _mm_set1_epi16((short)(256 - alpha));
+      __m128i vColor = _mm_mullo_epi16(
+                          _mm_unpacklo_epi8(_mm_set1_epi32((int)color), vZero),
+                          _mm_set1_epi16(alpha));
+      __m128i vDst, vLo, vHi;
+      for (; i + 4 <= iLength; i += 4) {
+         vDst = _mm_loadu_si128((__m128i*)(p + i));
+         vLo = _mm_unpacklo_epi8(vDst, vZero);
+         vHi = _mm_unpackhi_epi8(vDst, vZero);
+         vLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(vLo, vInvAlpha),
+                                            vColor), 8);
+         vHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(vHi, vInvAlpha),
+                                            vColor), 8);
+         _mm_storeu_si128((__m128i*)(p + i),
+                          _mm_and_si128(_mm_packus_epi16(vLo, vHi), vMask));
+      }
+   }
+#endif
+   for (; i < iLength; i++)
+      p[i] = (*pfBlend)(p[i], color, alpha);
+}
+
+/* Blends iLength pixels from (x, y) rightwards with color color by alpha
+   alpha.  Pixels off the screen are skipped.  It is a checked runtime error
+   for the drawing module to be uninitialized. */
+void Draw_blendSpan(int x, int y, int iLength, Color_T color, Uint8 alpha) {
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   Draw_markDirty(x, y, iLength, 1);
+   Draw_blendSpanClipped(x, y, iLength, color, alpha, &oScreenClip);
 }
 
 /* Draw a pixel at position (dX, dY) onto oScreen, with color R, G, B.  The
@@ -123,91 +436,377 @@ void Draw_blendPixel(int x, int y, Color_T color, Uint8 alpha) {
    is a checked runtime error for the drawing module to be uninitialized. */
 void Draw_drawScaledPixel(double dX, double dY, Color_T color) {
    int x, y;
-   assert(oScreen != NULL);
-   x = (int)((dX - dShiftX) * dScaleX + XRES / 2);
-   y = (int)((-dY + dShiftY) * dScaleY + YRES / 2);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   x = (int)((dX - oView.dShiftX) * oView.dScaleX + iWidth / 2);
+   y = (int)((-dY + oView.dShiftY) * oView.dScaleY + iHeight / 2);
+   if (x >= 0 && x < iWidth && y >= 0 && y < iHeight)
+      Draw_markPixel(x, y);
    Draw_drawPixel(x, y, color);
 }
 
-/* Draw a line from (x1, y1) to (x2, y2) onto the screen,
-   with color color and alpha alpha.  It is a checked runtime error for for
-   the drawing module to be uninitialized. */
-void Draw_drawLineAlpha(int x1, int y1, int x2, int y2, Color_T color, Uint8 alpha) {
-	int xaa, yaa, *a, *b, *a2, *b2, da, xd, yd;
-	double aa, db;
-	double realb;
+/* Project the iCount points (pfX[i], pfY[i]) to pixels (piX[i], piY[i])
+   under poView, as Draw_drawScaledPixels would under the current view.
+   Points far off the screen may come out as anything off the screen. */
+void Draw_projectPoints(const DrawView_T* poView, const float* pfX,
+                        const float* pfY, int iCount, int* piX, int* piY) {
+   float fScaleX = (float)poView->dScaleX, fScaleY = (float)poView->dScaleY;
+   float fShiftX = (float)poView->dShiftX, fShiftY = (float)poView->dShiftY;
+   float fX, fY;
+   int i = 0;
+
+#if defined(__SSE2__)
+   {
+      __m128 vScaleX = _mm_set1_ps(fScaleX), vScaleY = _mm_set1_ps(fScaleY);
+      __m128 vShiftX = _mm_set1_ps(fShiftX), vShiftY = _mm_set1_ps(fShiftY);
+      __m128 vHalfX = _mm_set1_ps((float)(iWidth / 2)), vHalfY = _mm_set1_ps((float)(iHeight / 2));
+      for (; i + 4 <= iCount; i += 4) {
+         __m128 vX = _mm_sub_ps(_mm_loadu_ps(pfX + i), vShiftX);
+         __m128 vY = _mm_sub_ps(vShiftY, _mm_loadu_ps(pfY + i));
+         vX = _mm_add_ps(_mm_mul_ps(vX, vScaleX), vHalfX);
+         vY = _mm_add_ps(_mm_mul_ps(vY, vScaleY), vHalfY);
+         /* Out of range conversions give INT_MIN, which is off the
+            screen. */
+         _mm_storeu_si128((__m128i*)(piX + i), _mm_cvttps_epi32(vX));
+         _mm_storeu_si128((__m128i*)(piY + i), _mm_cvttps_epi32(vY));
+      }
+   }
+#endif
+   for (; i < iCount; i++) {
+      fX = (pfX[i] - fShiftX) * fScaleX + iWidth / 2;
+      fY = (fShiftY - pfY[i]) * fScaleY + iHeight / 2;
+      piX[i] = fX > -1 && fX < iWidth ? (int)fX : -1;
+      piY[i] = fY > -1 && fY < iHeight ? (int)fY : -1;
+   }
+}
+
+/* Draw iCount pixels at positions (pfX[i], pfY[i]) onto oScreen, with color
+   color.  The positions are scaled and centered as for
+   Draw_drawScaledPixel, but a batch at a time.  It is a checked runtime
+   error for the drawing module to be uninitialized. */
+void Draw_drawScaledPixels(const float* pfX, const float* pfY, int iCount,
+                           Color_T color) {
+   Draw_drawScaledPixelsIn(&oView, pfX, pfY, iCount, color);
+}
+
+/* Draw iCount pixels at positions (pfX[i], pfY[i]) onto oScreen, with color
+   color, projected under poView as Draw_projectPoints does.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView to be NULL. */
+void Draw_drawScaledPixelsIn(const DrawView_T* poView, const float* pfX,
+                             const float* pfY, int iCount, Color_T color) {
+   int aiX[PIXEL_BATCH], aiY[PIXEL_BATCH];
+   Uint32* puPixels;
+   int iPitch, iDone, iBatch, i;
+
+   assert(oTarget != NULL || iHeadless);
+   assert(poView != NULL && pfX != NULL && pfY != NULL);
+   if (iHeadless)
+      return;
+
+   puPixels = (Uint32*)oTarget->pixels;
+   iPitch = oTarget->pitch / 4;
+   for (iDone = 0; iDone < iCount; iDone += iBatch) {
+      iBatch = iCount - iDone < PIXEL_BATCH ? iCount - iDone : PIXEL_BATCH;
+      Draw_projectPoints(poView, pfX + iDone, pfY + iDone, iBatch, aiX,
+                         aiY);
+      for (i = 0; i < iBatch; i++)
+         if (aiX[i] >= 0 && aiX[i] < iWidth && aiY[i] >= 0 && aiY[i] < iHeight) {
+            Draw_markPixel(aiX[i], aiY[i]);
+            puPixels[aiY[i] * iPitch + aiX[i]] = color;
+         }
+   }
+}
+
+/* Project the world space point (dX, dY) to pixel (*piX, *piY) under
+   poView, as Draw_drawScaledLine does with the ends of a line under the
+   current view. */
+void Draw_projectPoint(const DrawView_T* poView, double dX, double dY,
+                       int* piX, int* piY) {
+   *piX = (int)((dX - poView->dShiftX) * poView->dScaleX + iWidth / 2);
+   *piY = (int)((-dY + poView->dShiftY) * poView->dScaleY + iHeight / 2);
+}
+
+/* In house function for setting iLength pixels from (x, y) rightwards to
+   color, where they are inside poClip. */
+static void Draw_fillSpanClipped(int x, int y, int iLength, Color_T color,
+                                 const DrawClip_T* poClip) {
+   Uint32* p;
+   int i;
+
+   if (y < poClip->iTop || y >= poClip->iBottom)
+      return;
+   if (x < poClip->iLeft) {
+      iLength -= poClip->iLeft - x;
+      x = poClip->iLeft;
+   }
+   if (x + iLength > poClip->iRight)
+      iLength = poClip->iRight - x;
+
+   p = (Uint32*)oTarget->pixels + y * iPitch + x;
+   for (i = 0; i < iLength; i++)
+      p[i] = color;
+}
 
-   if ((x1 > XRES && x2 > XRES) ||
+/* In house function for blending iLength pixels from (x, y) rightwards,
+   where they are inside poClip, each by its own alpha.  Pixel i takes the
+   coverage in bits 8 to 15 of iB + i * iDb, scaled by alpha, or if
+   isInverse what is left of alpha after that. */
+static void Draw_blendRampClipped(int x, int y, int iLength, Color_T color,
+                                  int iB, int iDb, Uint8 alpha,
+                                  int isInverse, const DrawClip_T* poClip) {
+   Uint32* p;
+   int i = 0, iCover;
+
+   if (y < poClip->iTop || y >= poClip->iBottom)
+      return;
+   if (x < poClip->iLeft) {
+      iLength -= poClip->iLeft - x;
+      iB += (poClip->iLeft - x) * iDb;
+      x = poClip->iLeft;
+   }
+   if (x + iLength > poClip->iRight)
+      iLength = poClip->iRight - x;
+
+   p = (Uint32*)oTarget->pixels + y * iPitch + x;
+#if defined(__SSE2__)
+   /* Four pixels at a time as in Draw_blendSpanClipped, but with each
+      pixel's alpha spread across its own four channels. */
+   if (iPackedFormat) {
+      __m128i vZero = _mm_setzero_si128();
+      __m128i vMask = _mm_set1_epi32((int)(iRmask | iGmask | iBmask));
+      __m128i v256 = _mm_set1_epi16(256);
+      __m128i vColor = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), vZero);
+      __m128i vAlpha = _mm_set1_epi32(alpha);
+      __m128i vB = _mm_setr_epi32(iB, iB + iDb, iB + 2 * iDb, iB + 3 * iDb);
+      __m128i vStep = _mm_set1_epi32(4 * iDb);
+      __m128i vByte = _mm_set1_epi32(0xFF);
+      __m128i vCover, vLo, vHi, vDst, vALo, vAHi;
+      for (; i + 4 <= iLength; i += 4) {
+         /* Coverage times alpha fits in the low sixteen bits of each lane,
+            so one multiply-add per lane does it. */
+         vCover = _mm_and_si128(_mm_srli_epi32(vB, 8), vByte);
+         vCover = _mm_srli_epi32(_mm_madd_epi16(vCover, vAlpha), 8);
+         if (isInverse)
+            vCover = _mm_sub_epi32(vAlpha, vCover);
+         vB = _mm_add_epi32(vB, vStep);
+
+         vCover = _mm_packs_epi32(vCover, vCover);
+         vCover = _mm_unpacklo_epi16(vCover, vCover);
+         vALo = _mm_unpacklo_epi32(vCover, vCover);
+         vAHi = _mm_unpackhi_epi32(vCover, vCover);
+
+         vDst = _mm_loadu_si128((__m128i*)(p + i));
+         vLo = _mm_unpacklo_epi8(vDst, vZero);
+         vHi = _mm_unpackhi_epi8(vDst, vZero);
+         vLo = _mm_srli_epi16(
+                  _mm_add_epi16(_mm_mullo_epi16(vLo, _mm_sub_epi16(v256, vALo)),
+                                _mm_mullo_epi16(vColor, vALo)), 8);
+         vHi = _mm_srli_epi16(
+                  _mm_add_epi16(_mm_mullo_epi16(vHi, _mm_sub_epi16(v256, vAHi)),
+                                _mm_mullo_epi16(vColor, vAHi)), 8);
+         _mm_storeu_si128((__m128i*)(p + i),
+                          _mm_and_si128(_mm_packus_epi16(vLo, vHi), vMask));
+      }
+      iB += i * iDb;
+   }
+#endif
+   for (; i < iLength; i++, iB += iDb) {
+      iCover = ((iB >> 8) & 0xFF) * alpha >> 8;
+      p[i] = (*pfBlend)(p[i], color, isInverse ? alpha - iCover : iCover);
+   }
+}
+
+/* In house function for drawing the part of a line inside poClip.  Along
+   its major axis the line takes one step a pixel; across it, its position
+   is kept in fixed point, 16.16, offset by LINE_BIAS so it stays positive.
+   Each step draws the pixel the line is nearest, and blends the pixels
+   either side by how far the line is from each.  The start is worked out
+   against the whole screen, never the clip, and a clip only skips steps,
+   so every part comes out exactly as if the whole line were drawn at
+   once. */
+static void Draw_lineClipped(int x1, int y1, int x2, int y2, Color_T color,
+                             Uint8 alpha, const DrawClip_T* poClip) {
+   int isXMajor, a1, a2, b1, b2, iALimit, iBLimit, iAStart, iAEnd, iALo, iAHi;
+   int iBLo, iBHi, iB, iDb, iBPixel, iBLast, iCover, iRun, iStride, iSide, a;
+   double dDb, dLo, dHi, dSwap, dFrom, dTo;
+   Uint32* p;
+
+   if ((x1 > iWidth && x2 > iWidth) ||
        (x1 < 0    && x2 < 0)    ||
-       (y1 > YRES && y2 > YRES) ||
+       (y1 > iHeight && y2 > iHeight) ||
        (y1 < 0    && y2 < 0))
       return;
 
-	/* xaa:   the x aa offset value, either 1 or 0
-	 * yaa:   the y aa offset value, either 1 or 0
-	 * *a:    reference to either x or y, depending on which way we are
-	 *        drawing.
-	 * *b:    reference to either x or y, depending on which way we are
-	 *        drawing.
-	 * *a2:   reference to either x2 or y2, depending on which way we are
-	 *        drawing.
-	 * *b2:   reference to either x2 or y2, depending on which way we are
-	 *        drawing.
-	 * xd:    distance from x to x2
-	 * yd:    distance from y to y2
-	 * da:    change in a for each iteration, either 1 or -1
-	 * db:    change in b with respect to a
-	 * realb: real b value, as b is an int, and db is going to be a
-	 *        fraction
-	 * aa:    anti-aliasing value, fraction part of realb
-	 */
-
-	/* find x and y distances */
-	xd = x2 - x1;
-	yd = y2 - y1;
-
-	if (abs(xd) >= abs(yd)) {
-	/* draw left/right to left/right */
-		xaa = 0;
-		yaa = 1;
-		a = &x1;
-		b = &y1;
-		a2 = &x2;
-		b2 = &y2;
-		db = (double)yd / xd;
-	} else {
-	/* draw top/bottom to top/bottom */
-		xaa = 1;
-		yaa = 0;
-		a = &y1;
-		b = &x1;
-		a2 = &y2;
-		b2 = &x2;
-		db = (double)xd / yd;
-	}
-
-	/* left or right? */
-	da = (*a <= *a2) ? 1 : -1;
-	/* up or down? */
-	db *= da;
-	/* init realb */
-	realb = (double)*b;
-	/* we're stopping when we hit *a2, so we have to add +/-1 to it */
-	*a2 += da;
-
-	for (; *a != *a2; *a += da) {
-		*b = (int)(realb + 0.5);
-		aa = (realb + 0.5 - *b) * alpha;
-		Draw_blendPixel(x1 + xaa, y1 + yaa, color, (int)aa);
-		Draw_blendPixel(x1 - xaa, y1 - yaa, color, alpha - (int)aa);
-
-   	if (alpha < 255)
-			Draw_blendPixel(x1, y1, color, alpha);
-		else
-			Draw_drawPixel(x1, y1, color);
-
-		realb += db;
-	}
+   /* A horizontal line is three spans: half the alpha above and below, and
+      the full line in the middle. */
+   if (y1 == y2) {
+      int iLeft = x1 < x2 ? x1 : x2;
+      int iRight = x1 < x2 ? x2 : x1;
+      int iLength;
+      if (iLeft < 0)
+         iLeft = 0;
+      if (iRight > iWidth - 1)
+         iRight = iWidth - 1;
+      iLength = iRight - iLeft + 1;
+      Draw_blendSpanClipped(iLeft, y1 + 1, iLength, color, alpha / 2,
+                            poClip);
+      Draw_blendSpanClipped(iLeft, y1 - 1, iLength, color, alpha - alpha / 2,
+                            poClip);
+      if (alpha < 255)
+         Draw_blendSpanClipped(iLeft, y1, iLength, color, alpha, poClip);
+      else
+         Draw_fillSpanClipped(iLeft, y1, iLength, color, poClip);
+      return;
+   }
+
+   /* Step along whichever axis the line covers more of, in increasing
+      order; a is that axis and b the other. */
+   isXMajor = fabs((double)x2 - x1) >= fabs((double)y2 - y1);
+   if (isXMajor) {
+      a1 = x1; b1 = y1; a2 = x2; b2 = y2;
+      iALimit = iWidth;
+      iBLimit = iHeight;
+      iALo = poClip->iLeft;
+      iAHi = poClip->iRight;
+      iBLo = poClip->iTop;
+      iBHi = poClip->iBottom;
+      iStride = 1;
+      iSide = iPitch;
+   } else {
+      a1 = y1; b1 = x1; a2 = y2; b2 = x2;
+      iALimit = iHeight;
+      iBLimit = iWidth;
+      iALo = poClip->iTop;
+      iAHi = poClip->iBottom;
+      iBLo = poClip->iLeft;
+      iBHi = poClip->iRight;
+      iStride = iPitch;
+      iSide = 1;
+   }
+   if (a1 > a2) {
+      a = a1; a1 = a2; a2 = a;
+      a = b1; b1 = b2; b2 = a;
+   }
+   dDb = ((double)b2 - b1) / ((double)a2 - a1);
+
+   /* Only the steps on the screen, with the pixels either side of the line
+      on it too, are worth taking.  This is done in floating point, since
+      the ends may be far off the screen. */
+   dFrom = a1 > 0 ? a1 : 0;
+   dTo = a2 < iALimit - 1 ? a2 : iALimit - 1;
+   if (dDb != 0) {
+      dLo = a1 + (-1 - b1) / dDb;
+      dHi = a1 + (iBLimit - b1) / dDb;
+      if (dDb < 0) {
+         dSwap = dLo; dLo = dHi; dHi = dSwap;
+      }
+      if (floor(dLo) - 1 > dFrom)
+         dFrom = floor(dLo) - 1;
+      if (ceil(dHi) + 1 < dTo)
+         dTo = ceil(dHi) + 1;
+   }
+   else if (b1 < -1 || b1 > iBLimit)
+      return;
+   if (dFrom > dTo)
+      return;
+   iAStart = (int)dFrom;
+   iAEnd = (int)dTo;
+
+   iDb = (int)floor(dDb * 65536 + 0.5);
+   iB = (int)floor((b1 + (iAStart - a1) * dDb + 0.5 + LINE_BIAS) * 65536);
+
+   /* Skip to the clip, the same as stepping there. */
+   if (iAStart < iALo) {
+      iB += (iALo - iAStart) * iDb;
+      iAStart = iALo;
+   }
+   if (iAEnd > iAHi - 1)
+      iAEnd = iAHi - 1;
+   if (iAStart > iAEnd)
+      return;
+
+   /* A shallow line, in long runs along a row, is drawn a run at a time. */
+   if (isXMajor && abs(iDb) <= LINE_RUN_SLOPE) {
+      for (a = iAStart; a <= iAEnd; a += iRun) {
+         iBPixel = iB >> 16;
+         if (iDb > 0)
+            iRun = (((iBPixel + 1) << 16) - iB + iDb - 1) / iDb;
+         else if (iDb < 0)
+            iRun = (iB - (iBPixel << 16)) / -iDb + 1;
+         else
+            iRun = iAEnd - a + 1;
+         if (iRun > iAEnd - a + 1)
+            iRun = iAEnd - a + 1;
+
+         iBPixel -= LINE_BIAS;
+         Draw_blendRampClipped(a, iBPixel + 1, iRun, color, iB, iDb, alpha, 0,
+                               poClip);
+         Draw_blendRampClipped(a, iBPixel - 1, iRun, color, iB, iDb, alpha, 1,
+                               poClip);
+         if (alpha < 255)
+            Draw_blendSpanClipped(a, iBPixel, iRun, color, alpha, poClip);
+         else
+            Draw_fillSpanClipped(a, iBPixel, iRun, color, poClip);
+         iB += iRun * iDb;
+      }
+      return;
+   }
+
+   /* A vertical or diagonal line is the same distance from its pixels at
+      every step, so the blends need working out only once, and if it is
+      well inside the clip nothing needs clipping. */
+   iBPixel = (iB >> 16) - LINE_BIAS;
+   iBLast = iBPixel + (iAEnd - iAStart) * (iDb / 65536);
+   if ((iDb == 0 || abs(iDb) == 65536) &&
+       (iBPixel < iBLast ? iBPixel : iBLast) - 1 >= iBLo &&
+       (iBPixel < iBLast ? iBLast : iBPixel) + 1 < iBHi) {
+      iCover = ((iB >> 8) & 0xFF) * alpha >> 8;
+      p = (Uint32*)oTarget->pixels + iAStart * iStride + iBPixel * iSide;
+      iStride += (iDb / 65536) * iSide;
+      for (a = iAStart; a <= iAEnd; a++, p += iStride) {
+         p[iSide] = (*pfBlend)(p[iSide], color, iCover);
+         p[-iSide] = (*pfBlend)(p[-iSide], color, alpha - iCover);
+         *p = alpha < 255 ? (*pfBlend)(*p, color, alpha) : color;
+      }
+      return;
+   }
+
+   /* Anything else, a pixel at a time. */
+   for (a = iAStart; a <= iAEnd; a++, iB += iDb) {
+      iBPixel = (iB >> 16) - LINE_BIAS;
+      iCover = ((iB >> 8) & 0xFF) * alpha >> 8;
+      if (isXMajor) {
+         Draw_blendClipped(a, iBPixel + 1, color, iCover, poClip);
+         Draw_blendClipped(a, iBPixel - 1, color, alpha - iCover, poClip);
+         if (alpha < 255)
+            Draw_blendClipped(a, iBPixel, color, alpha, poClip);
+         else
+            Draw_plotClipped(a, iBPixel, color, poClip);
+      } else {
+         Draw_blendClipped(iBPixel + 1, a, color, iCover, poClip);
+         Draw_blendClipped(iBPixel - 1, a, color, alpha - iCover, poClip);
+         if (alpha < 255)
+            Draw_blendClipped(iBPixel, a, color, alpha, poClip);
+         else
+            Draw_plotClipped(iBPixel, a, color, poClip);
+      }
+   }
+}
+
+/* Draw a line from (x1, y1) to (x2, y2) onto the screen,
+   with color color and alpha alpha.  It is a checked runtime error for for
+   the drawing module to be uninitialized. */
+void Draw_drawLineAlpha(int x1, int y1, int x2, int y2, Color_T color, Uint8 alpha) {
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   Draw_markBox((x1 < x2 ? x1 : x2) - VISIBLE_MARGIN,
+                (y1 < y2 ? y1 : y2) - VISIBLE_MARGIN,
+                (x1 < x2 ? x2 : x1) + VISIBLE_MARGIN + 1,
+                (y1 < y2 ? y2 : y1) + VISIBLE_MARGIN + 1);
+   Draw_lineClipped(x1, y1, x2, y2, color, alpha, &oScreenClip);
 }
 
 /* Draw a line from (dX1, dY1) to (dX2, dY2) onto the screen,
@@ -217,75 +816,326 @@ void Draw_drawLineAlpha(int x1, int y1, int x2, int y2, Color_T color, Uint8 alp
 void Draw_drawScaledLine(double dX1, double dY1, double dX2, double dY2,
                    Color_T color) {
    double x1, x2, y1, y2;
-   assert(oScreen != NULL);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+
+   x1 = (dX1 - oView.dShiftX) * oView.dScaleX + iWidth / 2;
+   y1 = (-dY1 + oView.dShiftY) * oView.dScaleY + iHeight / 2;
+   x2 = (dX2 - oView.dShiftX) * oView.dScaleX + iWidth / 2;
+   y2 = (-dY2 + oView.dShiftY) * oView.dScaleY + iHeight / 2;
+   Draw_drawLineAlpha(x1, y1, x2, y2, color, 255);
+}
+
+/* Draw the part of the line from (dX1, dY1) to (dX2, dY2) that lies inside
+   poClip, exactly as Draw_drawScaledLine would draw it there under poView.
+   Drawing a line once for each of several clips that cover the screen
+   without overlapping gives the same pixels as drawing it once.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView or poClip to be NULL. */
+void Draw_drawScaledLineClipped(const DrawView_T* poView, double dX1,
+                                double dY1, double dX2, double dY2,
+                                Color_T color, const DrawClip_T* poClip) {
+   int x1, y1, x2, y2;
+   assert(oTarget != NULL || iHeadless);
+   assert(poView != NULL && poClip != NULL);
+   if (iHeadless)
+      return;
+
+   Draw_projectPoint(poView, dX1, dY1, &x1, &y1);
+   Draw_projectPoint(poView, dX2, dY2, &x2, &y2);
+   Draw_lineClipped(x1, y1, x2, y2, color, 255, poClip);
+}
+
+/* Draw a line from (dX1, dY1) to (dX2, dY2) onto the screen, with color
+   color, exactly as Draw_drawScaledLine would under poView.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView to be NULL. */
+void Draw_drawScaledLineIn(const DrawView_T* poView, double dX1,
+                           double dY1, double dX2, double dY2,
+                           Color_T color) {
+   int x1, y1, x2, y2;
+   assert(oTarget != NULL || iHeadless);
+   assert(poView != NULL);
+   if (iHeadless)
+      return;
 
-   x1 = (dX1 - dShiftX) * dScaleX + XRES / 2;
-   y1 = (-dY1 + dShiftY) * dScaleY + YRES / 2;
-   x2 = (dX2 - dShiftX) * dScaleX + XRES / 2;
-   y2 = (-dY2 + dShiftY) * dScaleY + YRES / 2;
+   Draw_projectPoint(poView, dX1, dY1, &x1, &y1);
+   Draw_projectPoint(poView, dX2, dY2, &x2, &y2);
    Draw_drawLineAlpha(x1, y1, x2, y2, color, 255);
 }
 
 /* If necessary, lock the screen for drawing.  It is a checked runtime error
    for the drawing module to be uninitialized. */
 void Draw_lockScreen() {
-   assert(oScreen != NULL);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
 
-   if (SDL_MUSTLOCK(oScreen))
-      if (SDL_LockSurface(oScreen) < 0)
+   if (SDL_MUSTLOCK(oTarget))
+      if (SDL_LockSurface(oTarget) < 0)
          return;
 }
 
 /* If necessary, unlock the screen after drawing.  It is a checked runtime
    error for the drawing module to be uninitialized. */
 void Draw_unlockScreen() {
-   assert(oScreen != NULL);
-   if (SDL_MUSTLOCK(oScreen))
-      SDL_UnlockSurface(oScreen);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+   if (SDL_MUSTLOCK(oTarget))
+      SDL_UnlockSurface(oTarget);
 }
 
-/* Flip the drawing buffer and the screen buffer.  It is a checked runtime
-   error for the drawing module to be uninitialized. */
+/* In house function for returning how many frames old what is on the
+   screen's drawing buffer is when drawing starts: 2 if the screen flips
+   between two pages, or 1 if it is presented by copying. */
+static int Draw_screenBuffers() {
+   return (oScreen->flags & SDL_DOUBLEBUF) == SDL_DOUBLEBUF ? 2 : 1;
+}
+
+/* In house function for filling poDirty with rectangles of oTarget that
+   cover every square drawn in frame iSince or later.  Squares next to each
+   other in a row are joined, and so are rows that match.  Returns the
+   number of rectangles. */
+static int Draw_collectDirty(int iSince) {
+   const int* piRow;
+   SDL_Rect* poRect;
+   int iNum = 0, iRowStart, x, y, iLeft, i;
+
+   for (y = 0; y < iCellsY; y++) {
+      piRow = piDrawn + y * iCellsX;
+      iRowStart = iNum;
+      x = 0;
+      while (x < iCellsX) {
+         if (piRow[x] < iSince) {
+            x++;
+            continue;
+         }
+         iLeft = x;
+         while (x < iCellsX && piRow[x] >= iSince)
+            x++;
+
+         /* Grow a rectangle ending just above down if it is as wide. */
+         for (i = 0; i < iRowStart; i++)
+            if (poDirty[i].x == iLeft * DIRTY_SIZE &&
+                poDirty[i].x + poDirty[i].w ==
+                   (x * DIRTY_SIZE < iWidth ? x * DIRTY_SIZE : iWidth) &&
+                poDirty[i].y + poDirty[i].h == y * DIRTY_SIZE)
+               break;
+         if (i < iRowStart) {
+            poDirty[i].h = ((y + 1) * DIRTY_SIZE < iHeight
+                            ? (y + 1) * DIRTY_SIZE : iHeight) - poDirty[i].y;
+            continue;
+         }
+
+         poRect = &poDirty[iNum++];
+         poRect->x = (Sint16)(iLeft * DIRTY_SIZE);
+         poRect->y = (Sint16)(y * DIRTY_SIZE);
+         poRect->w = (Uint16)((x * DIRTY_SIZE < iWidth ? x * DIRTY_SIZE
+                                                       : iWidth) - poRect->x);
+         poRect->h = (Uint16)(((y + 1) * DIRTY_SIZE < iHeight
+                               ? (y + 1) * DIRTY_SIZE : iHeight) - poRect->y);
+      }
+   }
+   return iNum;
+}
+
+/* In house function for scaling each pixel of oTarget inside poRect up to
+   an iUpscale square of oDst, which must be 32 bits per pixel and big
+   enough. */
+static void Draw_upscale(SDL_Surface* oDst, const SDL_Rect* poRect) {
+   const Uint32* puSrc;
+   Uint32* puDst;
+   int x, y, i, iDstPitch = oDst->pitch / 4;
+
+   for (y = poRect->y; y < poRect->y + poRect->h; y++) {
+      puSrc = (const Uint32*)oTarget->pixels + y * iPitch + poRect->x;
+      puDst = (Uint32*)oDst->pixels + y * iUpscale * iDstPitch +
+              poRect->x * iUpscale;
+      for (x = 0; x < poRect->w; x++)
+         for (i = 0; i < iUpscale; i++)
+            puDst[x * iUpscale + i] = puSrc[x];
+
+      /* The other rows of the square are copies of the first. */
+      for (i = 1; i < iUpscale; i++)
+         memcpy(puDst + i * iDstPitch, puDst,
+                poRect->w * iUpscale * sizeof(Uint32));
+   }
+}
+
+/* In house function for copying the iNumRects rectangles poRects of
+   oTarget onto the screen, scaling them up and converting them to the
+   screen's depth as need be. */
+static void Draw_present(const SDL_Rect* poRects, int iNumRects) {
+   SDL_Rect oSrc, oDst;
+   int i;
+
+   if (oStaging != NULL)
+      for (i = 0; i < iNumRects; i++) {
+         Draw_upscale(oStaging, &poRects[i]);
+         oSrc.x = (Sint16)(poRects[i].x * iUpscale);
+         oSrc.y = (Sint16)(poRects[i].y * iUpscale);
+         oSrc.w = (Uint16)(poRects[i].w * iUpscale);
+         oSrc.h = (Uint16)(poRects[i].h * iUpscale);
+         oDst = oSrc;
+         SDL_BlitSurface(oStaging, &oSrc, oScreen, &oDst);
+      }
+   else if (iUpscale == 1)
+      for (i = 0; i < iNumRects; i++) {
+         oSrc = poRects[i];
+         oDst = oSrc;
+         SDL_BlitSurface(oTarget, &oSrc, oScreen, &oDst);
+      }
+   else {
+      if (SDL_MUSTLOCK(oScreen))
+         if (SDL_LockSurface(oScreen) < 0)
+            return;
+      for (i = 0; i < iNumRects; i++)
+         Draw_upscale(oScreen, &poRects[i]);
+      if (SDL_MUSTLOCK(oScreen))
+         SDL_UnlockSurface(oScreen);
+   }
+}
+
+/* Flip the drawing buffer and the screen buffer, first copying what was
+   drawn onto the screen if it was drawn on a buffer.  Only the parts of
+   the screen drawn on this frame or cleared since the screen last showed
+   them are copied and updated.  It is a checked runtime error for the
+   drawing module to be uninitialized. */
 void Draw_flipScreen() {
-   assert(oScreen != NULL);
-   SDL_Flip(oScreen);
+   int iNumRects, i;
+
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless || oScreen == NULL)
+      return;
+
+   iNumRects = Draw_collectDirty(iFrame - Draw_screenBuffers());
+   if (oTarget != oScreen)
+      Draw_present(poDirty, iNumRects);
+   if (Draw_screenBuffers() == 2) {
+      SDL_Flip(oScreen);
+      return;
+   }
+   for (i = 0; i < iNumRects; i++) {
+      poDirty[i].x = (Sint16)(poDirty[i].x * iUpscale);
+      poDirty[i].y = (Sint16)(poDirty[i].y * iUpscale);
+      poDirty[i].w = (Uint16)(poDirty[i].w * iUpscale);
+      poDirty[i].h = (Uint16)(poDirty[i].h * iUpscale);
+   }
+   SDL_UpdateRects(oScreen, iNumRects, poDirty);
 }
 
-/* Fill the screen with iClearColor.  It is a checked runtime
-   error for the drawing module to be uninitialized. */
+/* Start a new frame by filling the screen with iClearColor.  Only what
+   was drawn on since the buffer being drawn on was last cleared is
+   filled, so a frame should be cleared once before each flip.  It is a
+   checked runtime error for the drawing module to be uninitialized. */
 void Draw_clearScreen() {
-   assert(oScreen != NULL);
-   SDL_FillRect(oScreen, NULL, iClearColor);
+   int iNumRects, i;
+
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return;
+
+   iFrame++;
+   iNumRects = Draw_collectDirty(iFrame - (oTarget == oScreen
+                                           ? Draw_screenBuffers() : 1));
+   for (i = 0; i < iNumRects; i++)
+      SDL_FillRect(oTarget, &poDirty[i], iClearColor);
+}
+
+/* Return row y of what is drawn on, Draw_getWidth pixels long.  The row is
+   only valid until the next drawing call.  It is a checked runtime error
+   for the drawing module to be uninitialized or headless, or for y not to
+   be a row. */
+const Color_T* Draw_getRow(int y) {
+   assert(oTarget != NULL);
+   assert(y >= 0 && y < iHeight);
+   return (const Color_T*)oTarget->pixels + y * iPitch;
+}
+
+/* Write the red, green and blue bytes of each of the iCount pixels at
+   puPixels, read from what is drawn on, to pucRGB, three bytes a pixel.  It
+   is a checked runtime error for the drawing module to be uninitialized or
+   headless, or for puPixels or pucRGB to be NULL. */
+void Draw_getRGB(const Color_T* puPixels, int iCount, Uint8* pucRGB) {
+   const SDL_PixelFormat* poFormat;
+   int i;
+
+   assert(oTarget != NULL);
+   assert(puPixels != NULL && pucRGB != NULL);
+   poFormat = oTarget->format;
+   for (i = 0; i < iCount; i++, pucRGB += 3) {
+      pucRGB[0] = (Uint8)(((puPixels[i] & poFormat->Rmask) >> poFormat->Rshift)
+                          << poFormat->Rloss);
+      pucRGB[1] = (Uint8)(((puPixels[i] & poFormat->Gmask) >> poFormat->Gshift)
+                          << poFormat->Gloss);
+      pucRGB[2] = (Uint8)(((puPixels[i] & poFormat->Bmask) >> poFormat->Bshift)
+                          << poFormat->Bloss);
+   }
 }
 
 /* Return the coorasponding Color_T to the given R, G, and B values.  It is a
    checked runtime error for the drawing module to be uninitialized. */
 Color_T Draw_getColor(char R, char G, char B) {
-   assert(oScreen != NULL);
-   return SDL_MapRGB(oScreen->format, (Uint8) R, (Uint8) G, (Uint8) B);
+   assert(oTarget != NULL || iHeadless);
+   if (iHeadless)
+      return ((Uint32)(Uint8)R << 16) | ((Uint32)(Uint8)G << 8) | (Uint8)B;
+   return SDL_MapRGB(oTarget->format, (Uint8) R, (Uint8) G, (Uint8) B);
+}
+
+/* Return 1 if any of the world space box from (dMinX, dMinY) to (dMaxX,
+   dMaxY) might be drawn on the screen at the current scale and shift, and
+   zero if none of it can be. */
+int Draw_isVisible(double dMinX, double dMinY, double dMaxX, double dMaxY) {
+   return Draw_isVisibleIn(&oView, dMinX, dMinY, dMaxX, dMaxY);
+}
+
+/* Return 1 if any of the world space box from (dMinX, dMinY) to (dMaxX,
+   dMaxY) might be drawn on the screen under poView, and zero if none of it
+   can be. */
+int Draw_isVisibleIn(const DrawView_T* poView, double dMinX, double dMinY,
+                     double dMaxX, double dMaxY) {
+   double dLeft = (dMinX - poView->dShiftX) * poView->dScaleX + iWidth / 2;
+   double dRight = (dMaxX - poView->dShiftX) * poView->dScaleX + iWidth / 2;
+   double dTop = (-dMaxY + poView->dShiftY) * poView->dScaleY + iHeight / 2;
+   double dBottom = (-dMinY + poView->dShiftY) * poView->dScaleY +
+                    iHeight / 2;
+
+   return dRight >= -VISIBLE_MARGIN && dLeft <= iWidth + VISIBLE_MARGIN &&
+          dBottom >= -VISIBLE_MARGIN && dTop <= iHeight + VISIBLE_MARGIN;
+}
+
+/* Copy the current scale and shift to *poView, so that what is recorded
+   now can be drawn the same way after they have changed.  It is a checked
+   runtime error for poView to be NULL. */
+void Draw_getView(DrawView_T* poView) {
+   assert(poView != NULL);
+   *poView = oView;
 }
 
-/* Set the scale to draw at to be dScale, dScale. */
+/* Set the scale to draw at to be dScale, dScale, in pixels of the default
+   screen. */
 void Draw_setScale(double dScale) {
-   dScaleX = dScaleY = dScale;
+   oView.dScaleX = oView.dScaleY = dScale * dResolution;
 }
 
 /* Scale the drawing scale by double dScale. */
 void Draw_scale(double dScale) {
-   dScaleX *= dScale;
-   dScaleY *= dScale;
+   oView.dScaleX *= dScale;
+   oView.dScaleY *= dScale;
 }
 
 /* Scale the drawing window to fit (-dX, +dX) , (-dY, +dY). */
 void Draw_scaleToPoint(double dX, double dY) {
    dX = abs(dX);
    dY = abs(dY);
-   dScaleX = XRES / (2 * dX);
-   dScaleY = YRES / (2 * dY);
+   oView.dScaleX = iWidth / (2 * dX);
+   oView.dScaleY = iHeight / (2 * dY);
 }
 
 /* Shift the drawing window to be centered around (dX, dY). */
 void Draw_shiftToPoint(double dX, double dY) {
-   dShiftX = dX;
-   dShiftY = dY;
+   oView.dShiftX = dX;
+   oView.dShiftY = dY;
 }
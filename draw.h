@@ -38,20 +38,90 @@
    functions and data types. */
 typedef Uint32 Color_T;
 
-/* Initialize the drawing module.  It is a checked runtime error for the
-   drawing module to be previously initialized. */
+/* A rectangle of pixels to draw within, from (iLeft, iTop) up to but not
+   including (iRight, iBottom). */
+typedef struct DrawClip {
+       int iLeft;
+       int iTop;
+       int iRight;
+       int iBottom;
+       } DrawClip_T;
+
+/* How world space maps to the screen: a point (dX, dY) lands on pixel
+   ((dX - dShiftX) * dScaleX, (dShiftY - dY) * dScaleY) from the center. */
+typedef struct DrawView {
+       double dScaleX;
+       double dScaleY;
+       double dShiftX;
+       double dShiftY;
+       } DrawView_T;
+
+/* Initialize the drawing module at the default screen size and depth.  It is
+   a checked runtime error for the drawing module to be previously
+   initialized. */
 void Draw_init();
 
+/* Initialize the drawing module with an iScreenWidth by iScreenHeight screen
+   of iDepth bits per pixel, drawn at 1 / iDownscale of that size and scaled
+   up to fill it.  Scales set by the other functions are in pixels of the
+   default 800 by 600 screen, so every mode shows the same part of the
+   world.  It is a checked runtime error for the drawing module to be
+   previously initialized, for either size not to be positive, for
+   iDownscale not to be positive, or for either size drawn at to be over
+   16384 pixels. */
+void Draw_initMode(int iScreenWidth, int iScreenHeight, int iDepth,
+                   int iDownscale);
+
+/* Initialize the drawing module without a screen.  SDL video is never
+   touched and every drawing call is dropped, so the simulation can run on
+   machines with no display.  It is a checked runtime error for the drawing
+   module to be previously initialized. */
+void Draw_initHeadless();
+
+/* Initialize the drawing module to draw on an iNewWidth by iNewHeight
+   buffer in memory instead of a screen.  No window is opened and flipping
+   does nothing; Draw_getRow reads back what was drawn.  It is a checked
+   runtime error for the drawing module to be previously initialized or for
+   either size not to be from 1 to 16384 pixels. */
+void Draw_initMemory(int iNewWidth, int iNewHeight);
+
+/* Return 1 if the drawing module was initialized without a screen, and zero
+   otherwise. */
+int Draw_isHeadless();
+
+/* Mark the iW by iH pixels from (x, y) as drawn on this frame, so that
+   they are cleared and presented.  The drawing functions that draw on the
+   whole screen mark what they draw themselves; Draw_drawPixel and
+   Draw_drawScaledLineClipped leave it to their callers.  It is a checked
+   runtime error for the drawing module to be uninitialized. */
+void Draw_markDirty(int x, int y, int iW, int iH);
+
 /* Draw a pixel at pixel (x, y) onto the screen, with color R, G, B.
    It is a checked runtime error for for the drawing module to be
    uninitialized. */
 void Draw_drawPixel(int x, int y, Color_T col);
 
+/* Blends pixel x, y onto oScreen according to alpha.  It is a checked runtime
+   error for the drawing module to be uninitialized. */
+void Draw_blendPixel(int x, int y, Color_T color, Uint8 alpha);
+
+/* Blends iLength pixels from (x, y) rightwards with color color by alpha
+   alpha.  Pixels off the screen are skipped.  It is a checked runtime error
+   for the drawing module to be uninitialized. */
+void Draw_blendSpan(int x, int y, int iLength, Color_T color, Uint8 alpha);
+
 /* Draw a pixel at position (dX, dY) onto oScreen, with color R, G, B.  The
    position will be scaled by the screen's scaling factor and centered.  It
    is a checked runtime error for the drawing module to be uninitialized. */
 void Draw_drawScaledPixel(double dX, double dY, Color_T color);
 
+/* Draw iCount pixels at positions (pfX[i], pfY[i]) onto oScreen, with color
+   color.  The positions are scaled and centered as for
+   Draw_drawScaledPixel, but a batch at a time.  It is a checked runtime
+   error for the drawing module to be uninitialized. */
+void Draw_drawScaledPixels(const float* pfX, const float* pfY, int iCount,
+                           Color_T color);
+
 /* Draw a line from (x1, y1) to (x2, y2) onto the screen,
    with color color and alpha alpha.  It is a checked runtime error for for
    the drawing module to be uninitialized. */
@@ -64,6 +134,51 @@ void Draw_drawLineAlpha(int x1, int y1, int x2, int y2, Color_T color, Uint8 alp
 void Draw_drawScaledLine(double dX1, double dY1, double dX2, double dY2,
                          Color_T color);
 
+/* Return the width in pixels of what is drawn on, which is narrower than
+   the screen if it is drawn at a lower resolution. */
+int Draw_getWidth();
+
+/* Return the height in pixels of what is drawn on, which is shorter than
+   the screen if it is drawn at a lower resolution. */
+int Draw_getHeight();
+
+/* Project the world space point (dX, dY) to pixel (*piX, *piY) under
+   poView, as Draw_drawScaledLine does with the ends of a line under the
+   current view. */
+void Draw_projectPoint(const DrawView_T* poView, double dX, double dY,
+                       int* piX, int* piY);
+
+/* Project the iCount points (pfX[i], pfY[i]) to pixels (piX[i], piY[i])
+   under poView, as Draw_drawScaledPixels would under the current view.
+   Points far off the screen may come out as anything off the screen. */
+void Draw_projectPoints(const DrawView_T* poView, const float* pfX,
+                        const float* pfY, int iCount, int* piX, int* piY);
+
+/* Draw the part of the line from (dX1, dY1) to (dX2, dY2) that lies inside
+   poClip, exactly as Draw_drawScaledLine would draw it there under poView.
+   Drawing a line once for each of several clips that cover the screen
+   without overlapping gives the same pixels as drawing it once.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView or poClip to be NULL. */
+void Draw_drawScaledLineClipped(const DrawView_T* poView, double dX1,
+                                double dY1, double dX2, double dY2,
+                                Color_T color, const DrawClip_T* poClip);
+
+/* Draw iCount pixels at positions (pfX[i], pfY[i]) onto oScreen, with color
+   color, projected under poView as Draw_projectPoints does.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView to be NULL. */
+void Draw_drawScaledPixelsIn(const DrawView_T* poView, const float* pfX,
+                             const float* pfY, int iCount, Color_T color);
+
+/* Draw a line from (dX1, dY1) to (dX2, dY2) onto the screen, with color
+   color, exactly as Draw_drawScaledLine would under poView.  It is a
+   checked runtime error for the drawing module to be uninitialized or for
+   poView to be NULL. */
+void Draw_drawScaledLineIn(const DrawView_T* poView, double dX1,
+                           double dY1, double dX2, double dY2,
+                           Color_T color);
+
 /* If necessary, lock the screen for drawing.  It is a checked runtime error
    for the drawing module to be uninitialized. */
 void Draw_lockScreen();
@@ -72,19 +187,53 @@ void Draw_lockScreen();
    error for the drawing module to be uninitialized. */
 void Draw_unlockScreen();
 
-/* Flip the drawing buffer and the screen buffer.  It is a checked runtime
-   error for the drawing module to be uninitialized. */
+/* Flip the drawing buffer and the screen buffer, first copying what was
+   drawn onto the screen if it was drawn on a buffer.  Only the parts of
+   the screen drawn on this frame or cleared since the screen last showed
+   them are copied and updated.  It is a checked runtime error for the
+   drawing module to be uninitialized. */
 void Draw_flipScreen();
 
-/* Fill the screen with iClearColor.  It is a checked runtime
-   error for the drawing module to be uninitialized. */
+/* Start a new frame by filling the screen with iClearColor.  Only what
+   was drawn on since the buffer being drawn on was last cleared is
+   filled, so a frame should be cleared once before each flip.  It is a
+   checked runtime error for the drawing module to be uninitialized. */
 void Draw_clearScreen();
 
+/* Return row y of what is drawn on, Draw_getWidth pixels long.  The row is
+   only valid until the next drawing call.  It is a checked runtime error
+   for the drawing module to be uninitialized or headless, or for y not to
+   be a row. */
+const Color_T* Draw_getRow(int y);
+
+/* Write the red, green and blue bytes of each of the iCount pixels at
+   puPixels, read from what is drawn on, to pucRGB, three bytes a pixel.  It
+   is a checked runtime error for the drawing module to be uninitialized or
+   headless, or for puPixels or pucRGB to be NULL. */
+void Draw_getRGB(const Color_T* puPixels, int iCount, Uint8* pucRGB);
+
 /* Return the coorasponding Color_T to the given R, G, and B values.  It is a
    checked runtime error for the drawing module to be uninitialized. */
 Color_T Draw_getColor(char R, char G, char B);
 
-/* Set the scale to draw at to be dScale, dScale. */
+/* Return 1 if any of the world space box from (dMinX, dMinY) to (dMaxX,
+   dMaxY) might be drawn on the screen at the current scale and shift, and
+   zero if none of it can be. */
+int Draw_isVisible(double dMinX, double dMinY, double dMaxX, double dMaxY);
+
+/* Return 1 if any of the world space box from (dMinX, dMinY) to (dMaxX,
+   dMaxY) might be drawn on the screen under poView, and zero if none of it
+   can be. */
+int Draw_isVisibleIn(const DrawView_T* poView, double dMinX, double dMinY,
+                     double dMaxX, double dMaxY);
+
+/* Copy the current scale and shift to *poView, so that what is recorded
+   now can be drawn the same way after they have changed.  It is a checked
+   runtime error for poView to be NULL. */
+void Draw_getView(DrawView_T* poView);
+
+/* Set the scale to draw at to be dScale, dScale, in pixels of the default
+   screen. */
 void Draw_setScale(double dScale);
 
 /* Scale the drawing scale by double dScale. */
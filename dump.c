@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: dump.c defines the implementation for the Dump ADT.  Raw
+ *    frames are written straight from the drawn-on rows; PPM frames are
+ *    converted a row at a time into one reused buffer, so each pixel is
+ *    copied once on its way to the file.
+ ___________________________________________________________________________*/
+
+#include "dump.h"
+#include "draw.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define MAX_PATH_LENGTH 1024
+
+/* Structure to store the dump datatype. */
+struct Dump {
+       /* The path, and whether it names a file per frame. */
+       char acPath[MAX_PATH_LENGTH];
+       int isPerFrame;
+
+       /* The open file, NULL between frames when there is one per frame. */
+       FILE* poFile;
+       int iFormat;
+       int iFrames;
+
+       /* One row of PPM, reused for every row. */
+       Uint8* pucRow;
+       int iRowLength;
+       };
+
+/* Returns a new dump writing frames in format iFormat to pcPath.  If pcPath
+   holds a %d each frame goes to its own file, named with the frame's
+   number; otherwise the frames follow one another in a single file, which
+   for DUMP_PPM is a stream most video tools can read.  A pcPath of "-" is
+   the standard output.  Returns NULL if the file cannot be opened.  It is a
+   checked runtime error for pcPath to be NULL or for iFormat not to be a
+   format. */
+Dump_T Dump_new(const char* pcPath, int iFormat) {
+   Dump_T oNewDump;
+
+   assert(pcPath != NULL);
+   assert(iFormat == DUMP_PPM || iFormat == DUMP_RAW);
+   if (strlen(pcPath) >= MAX_PATH_LENGTH)
+      return NULL;
+
+   oNewDump = (Dump_T)malloc(sizeof(struct Dump));
+   assert(oNewDump != NULL);
+   strcpy(oNewDump->acPath, pcPath);
+   oNewDump->isPerFrame = strstr(pcPath, "%d") != NULL;
+
+   /* The path is used as a format, so it may hold no other directive. */
+   if (oNewDump->isPerFrame &&
+       (strchr(pcPath, '%') != strstr(pcPath, "%d") ||
+        strchr(strstr(pcPath, "%d") + 1, '%') != NULL)) {
+      free(oNewDump);
+      return NULL;
+   }
+   oNewDump->iFormat = iFormat;
+   oNewDump->iFrames = 0;
+   oNewDump->pucRow = NULL;
+   oNewDump->iRowLength = 0;
+   oNewDump->poFile = NULL;
+
+   if (oNewDump->isPerFrame)
+      return oNewDump;
+   if (strcmp(pcPath, "-") == 0)
+      oNewDump->poFile = stdout;
+   else
+      oNewDump->poFile = fopen(pcPath, "wb");
+   if (oNewDump->poFile == NULL) {
+      free(oNewDump);
+      return NULL;
+   }
+   return oNewDump;
+}
+
+/* Closes the file of oDump and frees all memory it occupies.  Does nothing
+   if oDump is NULL. */
+void Dump_free(Dump_T oDump) {
+   if (oDump == NULL)
+      return;
+   if (oDump->poFile == stdout)
+      fflush(stdout);
+   else if (oDump->poFile != NULL)
+      fclose(oDump->poFile);
+   free(oDump->pucRow);
+   free(oDump);
+}
+
+/* In house function for writing the drawn-on pixels to poFile in the format
+   of oDump.  Returns 1 on success and zero on failure. */
+static int Dump_write(Dump_T oDump, FILE* poFile) {
+   int iWidth = Draw_getWidth(), iHeight = Draw_getHeight(), y;
+
+   if (oDump->iFormat == DUMP_RAW) {
+      for (y = 0; y < iHeight; y++)
+         if (fwrite(Draw_getRow(y), sizeof(Color_T), iWidth, poFile) !=
+             (size_t)iWidth)
+            return 0;
+      return 1;
+   }
+
+   if (oDump->iRowLength < 3 * iWidth) {
+      oDump->iRowLength = 3 * iWidth;
+      oDump->pucRow = (Uint8*)realloc(oDump->pucRow, oDump->iRowLength);
+      assert(oDump->pucRow != NULL);
+   }
+   if (fprintf(poFile, "P6\n%d %d\n255\n", iWidth, iHeight) < 0)
+      return 0;
+   for (y = 0; y < iHeight; y++) {
+      Draw_getRGB(Draw_getRow(y), iWidth, oDump->pucRow);
+      if (fwrite(oDump->pucRow, 3, iWidth, poFile) != (size_t)iWidth)
+         return 0;
+   }
+   return 1;
+}
+
+/* Writes what the drawing module has drawn as the next frame of oDump.
+   Returns 1 on success and zero if the frame could not be written.  It is a
+   checked runtime error for oDump to be NULL or for the drawing module to
+   be uninitialized or headless. */
+int Dump_frame(Dump_T oDump) {
+   char acName[MAX_PATH_LENGTH + 16];
+   FILE* poFile;
+   int iResult;
+
+   assert(oDump != NULL);
+   assert(!Draw_isHeadless());
+
+   if (!oDump->isPerFrame)
+      iResult = Dump_write(oDump, oDump->poFile);
+   else {
+      sprintf(acName, oDump->acPath, oDump->iFrames);
+      poFile = fopen(acName, "wb");
+      if (poFile == NULL)
+         return 0;
+      iResult = Dump_write(oDump, poFile);
+      if (fclose(poFile) != 0)
+         iResult = 0;
+   }
+
+   if (iResult)
+      oDump->iFrames++;
+   return iResult;
+}
+
+/* Returns the number of frames written to oDump.  It is a checked runtime
+   error for oDump to be NULL. */
+int Dump_getFrames(Dump_T oDump) {
+   assert(oDump != NULL);
+   return oDump->iFrames;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: dump.h defines the interface for the Dump ADT, which writes
+ *    each frame drawn to a file, as PPM images or as raw pixels.
+ ___________________________________________________________________________*/
+
+#ifndef DUMP_H
+#define DUMP_H
+
+/* Formats of frame. */
+#define DUMP_PPM 0 /* Binary PPM, eight bit red, green and blue. */
+#define DUMP_RAW 1 /* The drawn-on pixels as they are, four bytes each. */
+
+typedef struct Dump* Dump_T;
+
+/* Returns a new dump writing frames in format iFormat to pcPath.  If pcPath
+   holds a %d each frame goes to its own file, named with the frame's
+   number; otherwise the frames follow one another in a single file, which
+   for DUMP_PPM is a stream most video tools can read.  A pcPath of "-" is
+   the standard output.  Returns NULL if the file cannot be opened.  It is a
+   checked runtime error for pcPath to be NULL or for iFormat not to be a
+   format. */
+Dump_T Dump_new(const char* pcPath, int iFormat);
+
+/* Closes the file of oDump and frees all memory it occupies.  Does nothing
+   if oDump is NULL. */
+void Dump_free(Dump_T oDump);
+
+/* Writes what the drawing module has drawn as the next frame of oDump.
+   Returns 1 on success and zero if the frame could not be written.  It is a
+   checked runtime error for oDump to be NULL or for the drawing module to
+   be uninitialized or headless. */
+int Dump_frame(Dump_T oDump);
+
+/* Returns the number of frames written to oDump.  It is a checked runtime
+   error for oDump to be NULL. */
+int Dump_getFrames(Dump_T oDump);
+
+#endif
@@ -33,6 +33,7 @@
 #include "ship.h"
 #include "draw.h"
 #include "particlesys.h"
+#include "rng.h"
 #include "math.h"
 #include <assert.h>
 #include <stdlib.h>
@@ -45,6 +46,9 @@
 #define PART_PER_LENGTH_ORANGE 6
 #define PARTS_PER_LOG_THRUST_RED 3
 #define PART_PER_LENGTH_RED 2
+#define SMOKE_LIFETIME 10.0
+#define FLAME_LIFETIME 2.0
+#define RAND_BATCH 64 /* Particles placed per batch of random numbers. */
 
 /* Structure to store the engines datatype. */
 struct Engine {
@@ -53,17 +57,25 @@ struct Engine {
        ParticleSys_T oSmoke;
        ParticleSys_T oRedFlame;
        ParticleSys_T oOrangeFlame;
-       int isThrusting;
+       int isThrusting;  /* Fired during this step. */
+       int wasThrusting; /* Fired during the last step. */
+       double dDecayTime; /* Time towards the next decay. */
+       Rng_T oRng;
        };
 
-/* Returns a new engine with shape rect and thrust thrust. */
-Engine_T Engine_new(Rect_T rect, double thrust) {
+/* Returns a new engine with shape rect and thrust thrust.  Its smoke is
+   scattered by its own generator, seeded with ulSeed. */
+Engine_T Engine_new(Rect_T rect, double thrust, unsigned long ulSeed) {
    Engine_T oNewEngine = (Engine_T)malloc(sizeof(struct Engine));
    oNewEngine->oRect = rect;
    oNewEngine->dThrust = thrust;
-   oNewEngine->oSmoke = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_SMOKE), Draw_getColor((char)230, (char)230, (char)230));
-   oNewEngine->oRedFlame = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_RED), Draw_getColor((char)255, 20, 20));
-   oNewEngine->oOrangeFlame = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_ORANGE), Draw_getColor((char)180, (char)140, 60));
+   oNewEngine->isThrusting = 0;
+   oNewEngine->wasThrusting = 0;
+   oNewEngine->dDecayTime = 0;
+   oNewEngine->oRng = Rng_make(ulSeed);
+   oNewEngine->oSmoke = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_SMOKE), Draw_getColor((char)230, (char)230, (char)230), SMOKE_LIFETIME);
+   oNewEngine->oRedFlame = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_RED), Draw_getColor((char)255, 20, 20), FLAME_LIFETIME);
+   oNewEngine->oOrangeFlame = ParticleSys_new((int)(log(thrust) * PARTS_PER_LOG_THRUST_ORANGE), Draw_getColor((char)180, (char)140, 60), FLAME_LIFETIME);
 
    return oNewEngine;
 }
@@ -78,24 +90,57 @@ void Engine_free(Engine_T oEngine) {
    free(oEngine);
 }
 
+/* In house function for adding dCount particles to oPSys.  Each lands at
+   oBase plus a random amount from -1/2 to 1/2 of oSpread and from 0 to 1 of
+   oDrift.  The random numbers are made RAND_BATCH particles at a time. */
+static void Engine_spray(Engine_T oEngine, ParticleSys_T oPSys, double dCount,
+                         Vec2_T oBase, Vec2_T oSpread, Vec2_T oDrift) {
+   double adRand[2 * RAND_BATCH];
+   double drand1, drand2;
+   int iCount, iBatch, i;
+
+   iCount = dCount > 0 ? (int)ceil(dCount) : 0;
+   while (iCount > 0) {
+      iBatch = iCount < RAND_BATCH ? iCount : RAND_BATCH;
+      Rng_fillUniform(&oEngine->oRng, adRand, 2 * iBatch);
+      for (i = 0; i < iBatch; i++) {
+         drand1 = 0.5 - adRand[2 * i];
+         drand2 = adRand[2 * i + 1];
+         ParticleSys_add(oPSys,
+                         oBase.dX + drand1 * oSpread.dX + drand2 * oDrift.dX,
+                         oBase.dY + drand1 * oSpread.dY + drand2 * oDrift.dY,
+                         0, 0);
+      }
+      iCount -= iBatch;
+   }
+}
+
 /* Fires oEngine on oShip for time t.  It is a checked runtime error for
    oEngine or oShip to be NULL. */
 void Engine_thrust(Engine_T oEngine, Ship_T oShip, double t) {
    double xcen, ycen, xoff, yoff, xdir, ydir, xsmokeX, ysmokeX, xsmokeY, ysmokeY, vx, vy, mag;
-   int i;
+   Pose_T oPose;
+   Vec2_T offset, axisX, axisY, base, spread, drift;
    assert(oShip != NULL && oEngine != NULL);
 
    oEngine->isThrusting = 1;
 
+   /* The engine's rect is in body space; bring what we need into the
+      world. */
+   oPose = Ship_getPose(oShip);
+   offset = Pose_rotate(oPose, Rect_getOffset(oEngine->oRect));
+   axisX = Pose_rotate(oPose, Rect_getXAxis(oEngine->oRect));
+   axisY = Pose_rotate(oPose, Rect_getYAxis(oEngine->oRect));
+
    /* Center of engine's ship. */
-   xcen = Vector_getX(Rect_getCenter(oEngine->oRect));
-   ycen = Vector_getY(Rect_getCenter(oEngine->oRect));
+   xcen = oPose.oPos.dX;
+   ycen = oPose.oPos.dY;
    /* Offset of engine itself. */
-   xoff = Vector_getX(Rect_getOffset(oEngine->oRect));
-   yoff = Vector_getY(Rect_getOffset(oEngine->oRect));
+   xoff = offset.dX;
+   yoff = offset.dY;
    /* Direction of engine thrust vector. */
-   xdir = Vector_getX(Rect_getYAxis(oEngine->oRect));
-   ydir = Vector_getY(Rect_getYAxis(oEngine->oRect));
+   xdir = axisY.dX;
+   ydir = axisY.dY;
    /* Ship's velocity vector. */
    vx = Ship_getVX(oShip);
    vy = Ship_getVY(oShip);
@@ -103,33 +148,28 @@ void Engine_thrust(Engine_T oEngine, Ship_T oShip, double t) {
    mag = oEngine->dThrust;
 
    /* These determine the random placement of smoke dots. */
-   xsmokeX = Vector_getX(Rect_getXAxis(oEngine->oRect)) * Rect_getXExt(oEngine->oRect);
-   ysmokeX = Vector_getY(Rect_getXAxis(oEngine->oRect)) * Rect_getXExt(oEngine->oRect);
-   xsmokeY = Vector_getX(Rect_getYAxis(oEngine->oRect)) * Rect_getYExt(oEngine->oRect);
-   ysmokeY = Vector_getY(Rect_getYAxis(oEngine->oRect)) * Rect_getYExt(oEngine->oRect);
+   xsmokeX = axisX.dX * Rect_getXExt(oEngine->oRect);
+   ysmokeX = axisX.dY * Rect_getXExt(oEngine->oRect);
+   xsmokeY = axisY.dX * Rect_getYExt(oEngine->oRect);
+   ysmokeY = axisY.dY * Rect_getYExt(oEngine->oRect);
 
    /* Apply the force. */
    Ship_applyForce(oShip, xdir*mag, ydir*mag, xoff, yoff);
 
-   /* Add some randomized smoke. */
-   for(i = 0; i < PART_PER_LENGTH_SMOKE * Rect_getXExt(oEngine->oRect); i++) {
-      double drand1 = (RAND_MAX / 2.0 - rand()) / (double)RAND_MAX;
-      double drand2 = rand() / (double)RAND_MAX;
-      ParticleSys_add(oEngine->oSmoke, xoff + xcen + drand1 * xsmokeX - xsmokeY + drand2*vx*t,
-                      yoff + ycen + drand1 * ysmokeX - ysmokeY + drand2*vy*t);
-   }
-   for(i = 0; i < PART_PER_LENGTH_RED * Rect_getXExt(oEngine->oRect); i++) {
-      double drand1 = (RAND_MAX / 2.0 - rand()) / (double)RAND_MAX;
-      double drand2 = rand() / (double)RAND_MAX;
-      ParticleSys_add(oEngine->oRedFlame, xoff + xcen + drand1 * xsmokeX - xsmokeY + drand2*vx*t,
-                      yoff + ycen + drand1 * ysmokeX - ysmokeY + drand2*vy*t);
-   }
-   for(i = 0; i < PART_PER_LENGTH_ORANGE * Rect_getXExt(oEngine->oRect); i++) {
-      double drand1 = (RAND_MAX / 2.0 - rand()) / (double)RAND_MAX;
-      double drand2 = rand() / (double)RAND_MAX;
-      ParticleSys_add(oEngine->oOrangeFlame, xoff + xcen + drand1 * xsmokeX - xsmokeY + drand2*vx*t,
-                      yoff + ycen + drand1 * ysmokeX - ysmokeY + drand2*vy*t);
-   }
+   /* Add some randomized smoke, spread across the back of the engine and
+      trailing back over the ground it covered this step. */
+   base = Vec2_make(xoff + xcen - xsmokeY, yoff + ycen - ysmokeY);
+   spread = Vec2_make(xsmokeX, ysmokeX);
+   drift = Vec2_make(vx * t, vy * t);
+   Engine_spray(oEngine, oEngine->oSmoke,
+                PART_PER_LENGTH_SMOKE * Rect_getXExt(oEngine->oRect),
+                base, spread, drift);
+   Engine_spray(oEngine, oEngine->oRedFlame,
+                PART_PER_LENGTH_RED * Rect_getXExt(oEngine->oRect),
+                base, spread, drift);
+   Engine_spray(oEngine, oEngine->oOrangeFlame,
+                PART_PER_LENGTH_ORANGE * Rect_getXExt(oEngine->oRect),
+                base, spread, drift);
 }
 
 
@@ -139,10 +179,10 @@ void Engine_thrustRight(Engine_T oEngine, Ship_T oShip, double t) {
    double xpos, ypos, xdir, ydir;
    assert(oEngine != NULL && oShip != NULL);
 
-   xpos = Vector_getX(Rect_getOffset(oEngine->oRect));
-   ypos = Vector_getY(Rect_getOffset(oEngine->oRect));
-   xdir = Vector_getX(Rect_getYAxis(oEngine->oRect));
-   ydir = Vector_getY(Rect_getYAxis(oEngine->oRect));
+   xpos = Rect_getOffset(oEngine->oRect).dX;
+   ypos = Rect_getOffset(oEngine->oRect).dY;
+   xdir = Rect_getYAxis(oEngine->oRect).dX;
+   ydir = Rect_getYAxis(oEngine->oRect).dY;
    if((ydir * xpos - xdir * ypos) > CCW_TOLERANCE)
       Engine_thrust(oEngine, oShip, t);
 }
@@ -153,37 +193,46 @@ void Engine_thrustLeft(Engine_T oEngine, Ship_T oShip, double t) {
    double xpos, ypos, xdir, ydir;
    assert(oEngine != NULL && oShip != NULL);
 
-   xpos = Vector_getX(Rect_getOffset(oEngine->oRect));
-   ypos = Vector_getY(Rect_getOffset(oEngine->oRect));
-   xdir = Vector_getX(Rect_getYAxis(oEngine->oRect));
-   ydir = Vector_getY(Rect_getYAxis(oEngine->oRect));
+   xpos = Rect_getOffset(oEngine->oRect).dX;
+   ypos = Rect_getOffset(oEngine->oRect).dY;
+   xdir = Rect_getYAxis(oEngine->oRect).dX;
+   ydir = Rect_getYAxis(oEngine->oRect).dY;
    if((ydir * xpos - xdir * ypos) < -CCW_TOLERANCE)
       Engine_thrust(oEngine, oShip, t);
 }
 
-/* Draws the smoke of oEngine.  It is a checked runtime error
-   for oEngine to be NULL. */
-void Engine_drawSmoke(Engine_T oEngine, double t) {
+/* Draws the smoke of oEngine, and its flames if it fired during the last
+   step.  It is a checked runtime error for oEngine to be NULL. */
+void Engine_drawSmoke(Engine_T oEngine) {
    assert(oEngine != NULL);
-   Engine_decaySmoke(oEngine, t);
    ParticleSys_draw(oEngine->oSmoke);
-   if(oEngine->isThrusting) {
+   if(oEngine->wasThrusting) {
       ParticleSys_draw(oEngine->oRedFlame);
       ParticleSys_draw(oEngine->oOrangeFlame);
    }
-   oEngine->isThrusting = 0;
 }
 
-/* Decays the smoke of oEngine.  It is a checked runtime error
-   for oEngine to be NULL. */
+/* Ages the smoke of oEngine by time t, and decays it.  Call it once at the
+   end of each step.  It is a checked runtime error for oEngine to be
+   NULL. */
 void Engine_decaySmoke(Engine_T oEngine, double t) {
-   static double time = 0;
+   int iDecays;
    assert(oEngine != NULL);
-   time += t;
-   if (time > DECAY_THRESHOLD) {
-      ParticleSys_decay(oEngine->oSmoke);
-      ParticleSys_decay(oEngine->oRedFlame);
-      ParticleSys_decay(oEngine->oOrangeFlame);
-      time -= DECAY_THRESHOLD;
+   ParticleSys_update(oEngine->oSmoke, t);
+   ParticleSys_update(oEngine->oRedFlame, t);
+   ParticleSys_update(oEngine->oOrangeFlame, t);
+
+   /* One particle goes from each system for every DECAY_THRESHOLD that has
+      passed, all at once. */
+   oEngine->dDecayTime += t;
+   iDecays = (int)(oEngine->dDecayTime / DECAY_THRESHOLD);
+   if (iDecays > 0) {
+      ParticleSys_decayMany(oEngine->oSmoke, iDecays);
+      ParticleSys_decayMany(oEngine->oRedFlame, iDecays);
+      ParticleSys_decayMany(oEngine->oOrangeFlame, iDecays);
+      oEngine->dDecayTime -= iDecays * DECAY_THRESHOLD;
    }
+
+   oEngine->wasThrusting = oEngine->isThrusting;
+   oEngine->isThrusting = 0;
 }
@@ -33,11 +33,13 @@
 
 #include "rect.h"
 #include "ship.h"
+#include "rng.h"
 
 typedef struct Engine* Engine_T;
 
-/* Returns a new engine with shape oRect and thrust dThrust. */
-Engine_T Engine_new(Rect_T oRect, double dThrust);
+/* Returns a new engine with shape oRect and thrust dThrust.  Its smoke is
+   scattered by its own generator, seeded with ulSeed. */
+Engine_T Engine_new(Rect_T oRect, double dThrust, unsigned long ulSeed);
 
 /* Frees all memory occupied by oEngine.  Does nothing if oEngine is NULL. */
 void Engine_free(Engine_T oEngine);
@@ -54,12 +56,13 @@ void Engine_thrustRight(Engine_T oEngine, Ship_T oShip, double t);
    runtime error for oEngine or oShip to be NULL. */
 void Engine_thrustLeft(Engine_T oEngine, Ship_T oShip, double t);
 
-/* Draws the smoke of oEngine.  It is a checked runtime error
-   for oEngine to be NULL. */
-void Engine_drawSmoke(Engine_T oEngine, double t);
+/* Draws the smoke of oEngine, and its flames if it fired during the last
+   step.  It is a checked runtime error for oEngine to be NULL. */
+void Engine_drawSmoke(Engine_T oEngine);
 
-/* Decays the smoke of oEngine.  It is a checked runtime error
-   for oEngine to be NULL. */
+/* Ages the smoke of oEngine by time t, and decays it.  Call it once at the
+   end of each step.  It is a checked runtime error for oEngine to be
+   NULL. */
 void Engine_decaySmoke(Engine_T oEngine, double t);
 
 #endif
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: grid.c defines the implementation for the Grid ADT.  Cells
+ *    are hashed into a fixed number of buckets, so the grid covers the
+ *    whole plane without needing to know the size of the world.  Each bucket
+ *    also lists the entries whose centers are in its cells, which is all
+ *    the neighbour queries need to look at.
+ ___________________________________________________________________________*/
+
+#include "grid.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#define NUM_BUCKETS 4096 /* Must be a power of two. */
+#define INITIAL_CAPACITY 8
+
+/* One entry's presence in one cell. */
+struct Slot {
+       int iEntry;
+       int iCellX;
+       int iCellY;
+       };
+
+/* A hash bucket, holding the slots of every cell that hashes to it, and
+   the entries centered in those cells. */
+struct Bucket {
+       struct Slot* poSlots;
+       int iNum;
+       int iCapacity;
+
+       int* piCentered;
+       int iNumCentered;
+       int iCenteredCapacity;
+       };
+
+/* An item in the grid, along with the block of cells it covers. */
+struct Entry {
+       void* pvItem;
+       double dX;
+       double dY;
+       double dRadius;
+       int iMinX, iMinY, iMaxX, iMaxY;
+       int iCellX, iCellY; /* The cell the center is in. */
+       int iNextFree; /* Next free entry, or -1 if this one is in use. */
+       };
+
+/* Structure to store the grid datatype. */
+struct Grid {
+       double dCellSize;
+       double dInverseCellSize;
+       struct Bucket aoBuckets[NUM_BUCKETS];
+
+       struct Entry* poEntries;
+       int iNumEntries;
+       int iEntryCapacity;
+       int iFirstFree;
+       };
+
+/* In house function for finding the bucket of cell (iCellX, iCellY). */
+static struct Bucket* Grid_bucket(Grid_T oGrid, int iCellX, int iCellY) {
+   unsigned int iHash = (unsigned int)iCellX * 73856093u ^
+                        (unsigned int)iCellY * 19349663u;
+   return &oGrid->aoBuckets[iHash & (NUM_BUCKETS - 1)];
+}
+
+/* In house function for finding the cell coordinate of dPos. */
+static int Grid_cell(Grid_T oGrid, double dPos) {
+   return (int)floor(dPos * oGrid->dInverseCellSize);
+}
+
+/* In house function for adding entry iEntry to every cell it covers. */
+static void Grid_link(Grid_T oGrid, int iEntry) {
+   struct Entry* poEntry = &oGrid->poEntries[iEntry];
+   struct Bucket* poBucket;
+   int x, y;
+
+   for (y = poEntry->iMinY; y <= poEntry->iMaxY; y++) {
+      for (x = poEntry->iMinX; x <= poEntry->iMaxX; x++) {
+         poBucket = Grid_bucket(oGrid, x, y);
+         if (poBucket->iNum == poBucket->iCapacity) {
+            poBucket->iCapacity = poBucket->iCapacity ?
+                                  2 * poBucket->iCapacity : INITIAL_CAPACITY;
+            poBucket->poSlots = (struct Slot*)realloc(poBucket->poSlots,
+                                poBucket->iCapacity * sizeof(struct Slot));
+            assert(poBucket->poSlots != NULL);
+         }
+         poBucket->poSlots[poBucket->iNum].iEntry = iEntry;
+         poBucket->poSlots[poBucket->iNum].iCellX = x;
+         poBucket->poSlots[poBucket->iNum].iCellY = y;
+         poBucket->iNum++;
+      }
+   }
+}
+
+/* In house function for removing entry iEntry from every cell it covers. */
+static void Grid_unlink(Grid_T oGrid, int iEntry) {
+   struct Entry* poEntry = &oGrid->poEntries[iEntry];
+   struct Bucket* poBucket;
+   int x, y, i;
+
+   for (y = poEntry->iMinY; y <= poEntry->iMaxY; y++) {
+      for (x = poEntry->iMinX; x <= poEntry->iMaxX; x++) {
+         poBucket = Grid_bucket(oGrid, x, y);
+         for (i = 0; i < poBucket->iNum; i++) {
+            if (poBucket->poSlots[i].iEntry == iEntry &&
+                poBucket->poSlots[i].iCellX == x &&
+                poBucket->poSlots[i].iCellY == y) {
+               poBucket->poSlots[i] = poBucket->poSlots[--poBucket->iNum];
+               break;
+            }
+         }
+      }
+   }
+}
+
+/* In house function for adding entry iEntry to the bucket of the cell its
+   center is in. */
+static void Grid_linkCenter(Grid_T oGrid, int iEntry) {
+   struct Entry* poEntry = &oGrid->poEntries[iEntry];
+   struct Bucket* poBucket = Grid_bucket(oGrid, poEntry->iCellX,
+                                         poEntry->iCellY);
+
+   if (poBucket->iNumCentered == poBucket->iCenteredCapacity) {
+      poBucket->iCenteredCapacity = poBucket->iCenteredCapacity ?
+                                    2 * poBucket->iCenteredCapacity
+                                    : INITIAL_CAPACITY;
+      poBucket->piCentered = (int*)realloc(poBucket->piCentered,
+                             poBucket->iCenteredCapacity * sizeof(int));
+      assert(poBucket->piCentered != NULL);
+   }
+   poBucket->piCentered[poBucket->iNumCentered++] = iEntry;
+}
+
+/* In house function for removing entry iEntry from the bucket of the cell
+   its center is in. */
+static void Grid_unlinkCenter(Grid_T oGrid, int iEntry) {
+   struct Entry* poEntry = &oGrid->poEntries[iEntry];
+   struct Bucket* poBucket = Grid_bucket(oGrid, poEntry->iCellX,
+                                         poEntry->iCellY);
+   int i;
+
+   for (i = 0; i < poBucket->iNumCentered; i++) {
+      if (poBucket->piCentered[i] == iEntry) {
+         poBucket->piCentered[i] =
+            poBucket->piCentered[--poBucket->iNumCentered];
+         break;
+      }
+   }
+}
+
+/* In house function for working out the block of cells poEntry covers. */
+static void Grid_cover(Grid_T oGrid, struct Entry* poEntry) {
+   poEntry->iMinX = Grid_cell(oGrid, poEntry->dX - poEntry->dRadius);
+   poEntry->iMinY = Grid_cell(oGrid, poEntry->dY - poEntry->dRadius);
+   poEntry->iMaxX = Grid_cell(oGrid, poEntry->dX + poEntry->dRadius);
+   poEntry->iMaxY = Grid_cell(oGrid, poEntry->dY + poEntry->dRadius);
+   poEntry->iCellX = Grid_cell(oGrid, poEntry->dX);
+   poEntry->iCellY = Grid_cell(oGrid, poEntry->dY);
+}
+
+/* Returns a new, empty grid whose square cells are dCellSize on a side.
+   Cells should be a little bigger than a typical object. */
+Grid_T Grid_new(double dCellSize) {
+   Grid_T oNewGrid;
+   int i;
+
+   assert(dCellSize > 0);
+   oNewGrid = (Grid_T)malloc(sizeof(struct Grid));
+   assert(oNewGrid != NULL);
+
+   oNewGrid->dCellSize = dCellSize;
+   oNewGrid->dInverseCellSize = 1 / dCellSize;
+   for (i = 0; i < NUM_BUCKETS; i++) {
+      oNewGrid->aoBuckets[i].poSlots = NULL;
+      oNewGrid->aoBuckets[i].iNum = 0;
+      oNewGrid->aoBuckets[i].iCapacity = 0;
+      oNewGrid->aoBuckets[i].piCentered = NULL;
+      oNewGrid->aoBuckets[i].iNumCentered = 0;
+      oNewGrid->aoBuckets[i].iCenteredCapacity = 0;
+   }
+   oNewGrid->poEntries = NULL;
+   oNewGrid->iNumEntries = 0;
+   oNewGrid->iEntryCapacity = 0;
+   oNewGrid->iFirstFree = -1;
+
+   return oNewGrid;
+}
+
+/* Frees all memory occupied by oGrid.  Does nothing if oGrid is NULL. */
+void Grid_free(Grid_T oGrid) {
+   int i;
+   if (oGrid == NULL)
+      return;
+   for (i = 0; i < NUM_BUCKETS; i++) {
+      free(oGrid->aoBuckets[i].poSlots);
+      free(oGrid->aoBuckets[i].piCentered);
+   }
+   free(oGrid->poEntries);
+   free(oGrid);
+}
+
+/* Adds pvItem to oGrid as a circle of radius dRadius centered at (dX, dY).
+   Returns a handle for the new entry.  It is a checked runtime error for
+   oGrid to be NULL. */
+int Grid_insert(Grid_T oGrid, void* pvItem, double dX, double dY,
+                double dRadius) {
+   struct Entry* poEntry;
+   int iEntry;
+
+   assert(oGrid != NULL);
+
+   if (oGrid->iFirstFree != -1) {
+      iEntry = oGrid->iFirstFree;
+      oGrid->iFirstFree = oGrid->poEntries[iEntry].iNextFree;
+   }
+   else {
+      if (oGrid->iNumEntries == oGrid->iEntryCapacity) {
+         oGrid->iEntryCapacity = oGrid->iEntryCapacity ?
+                                 2 * oGrid->iEntryCapacity : INITIAL_CAPACITY;
+         oGrid->poEntries = (struct Entry*)realloc(oGrid->poEntries,
+                            oGrid->iEntryCapacity * sizeof(struct Entry));
+         assert(oGrid->poEntries != NULL);
+      }
+      iEntry = oGrid->iNumEntries++;
+   }
+
+   poEntry = &oGrid->poEntries[iEntry];
+   poEntry->pvItem = pvItem;
+   poEntry->dX = dX;
+   poEntry->dY = dY;
+   poEntry->dRadius = dRadius;
+   poEntry->iNextFree = -1;
+   Grid_cover(oGrid, poEntry);
+   Grid_link(oGrid, iEntry);
+   Grid_linkCenter(oGrid, iEntry);
+
+   return iEntry;
+}
+
+/* Moves entry iEntry of oGrid to be centered at (dX, dY).  Entries that stay
+   within the same cells only have their position updated.  It is a checked
+   runtime error for oGrid to be NULL or for iEntry not to be in oGrid. */
+void Grid_move(Grid_T oGrid, int iEntry, double dX, double dY) {
+   struct Entry* poEntry;
+   struct Entry oMoved;
+   int isRecovered, isRecentered;
+
+   assert(oGrid != NULL);
+   assert(iEntry >= 0 && iEntry < oGrid->iNumEntries);
+   poEntry = &oGrid->poEntries[iEntry];
+   assert(poEntry->iNextFree == -1);
+
+   oMoved = *poEntry;
+   oMoved.dX = dX;
+   oMoved.dY = dY;
+   Grid_cover(oGrid, &oMoved);
+
+   isRecovered = oMoved.iMinX != poEntry->iMinX ||
+                 oMoved.iMinY != poEntry->iMinY ||
+                 oMoved.iMaxX != poEntry->iMaxX ||
+                 oMoved.iMaxY != poEntry->iMaxY;
+   isRecentered = oMoved.iCellX != poEntry->iCellX ||
+                  oMoved.iCellY != poEntry->iCellY;
+   if (isRecovered)
+      Grid_unlink(oGrid, iEntry);
+   if (isRecentered)
+      Grid_unlinkCenter(oGrid, iEntry);
+   *poEntry = oMoved;
+   if (isRecovered)
+      Grid_link(oGrid, iEntry);
+   if (isRecentered)
+      Grid_linkCenter(oGrid, iEntry);
+}
+
+/* Removes entry iEntry from oGrid.  The handle may later be reused.  It is a
+   checked runtime error for oGrid to be NULL or for iEntry not to be in
+   oGrid. */
+void Grid_remove(Grid_T oGrid, int iEntry) {
+   assert(oGrid != NULL);
+   assert(iEntry >= 0 && iEntry < oGrid->iNumEntries);
+   assert(oGrid->poEntries[iEntry].iNextFree == -1);
+
+   Grid_unlink(oGrid, iEntry);
+   Grid_unlinkCenter(oGrid, iEntry);
+   oGrid->poEntries[iEntry].pvItem = NULL;
+   oGrid->poEntries[iEntry].iNextFree = oGrid->iFirstFree;
+   oGrid->iFirstFree = iEntry;
+}
+
+/* Calls pfPair once for every pair of items in oGrid whose circles overlap,
+   passing the two items and pvExtra.  It is a checked runtime error for
+   oGrid or pfPair to be NULL. */
+void Grid_mapPairs(Grid_T oGrid,
+                   void (*pfPair)(void* pvItem1, void* pvItem2, void* pvExtra),
+                   void* pvExtra) {
+   struct Bucket* poBucket;
+   struct Slot *poSlot1, *poSlot2;
+   struct Entry *poEntry1, *poEntry2;
+   double dX, dY, dR;
+   int b, i, j;
+
+   assert(oGrid != NULL && pfPair != NULL);
+
+   for (b = 0; b < NUM_BUCKETS; b++) {
+      poBucket = &oGrid->aoBuckets[b];
+      for (i = 0; i < poBucket->iNum; i++) {
+         poSlot1 = &poBucket->poSlots[i];
+         poEntry1 = &oGrid->poEntries[poSlot1->iEntry];
+         for (j = i + 1; j < poBucket->iNum; j++) {
+            poSlot2 = &poBucket->poSlots[j];
+
+            /* Different cells can share a bucket. */
+            if (poSlot1->iCellX != poSlot2->iCellX ||
+                poSlot1->iCellY != poSlot2->iCellY)
+               continue;
+
+            /* Two entries can share several cells.  Only report the pair
+               from the lowest cell they have in common. */
+            poEntry2 = &oGrid->poEntries[poSlot2->iEntry];
+            if (poSlot1->iCellX != (poEntry1->iMinX > poEntry2->iMinX ?
+                                    poEntry1->iMinX : poEntry2->iMinX) ||
+                poSlot1->iCellY != (poEntry1->iMinY > poEntry2->iMinY ?
+                                    poEntry1->iMinY : poEntry2->iMinY))
+               continue;
+
+            dX = poEntry1->dX - poEntry2->dX;
+            dY = poEntry1->dY - poEntry2->dY;
+            dR = poEntry1->dRadius + poEntry2->dRadius;
+            if (dX * dX + dY * dY <= dR * dR)
+               (*pfPair)(poEntry1->pvItem, poEntry2->pvItem, pvExtra);
+         }
+      }
+   }
+}
+
+/* Calls pfFound once for every item in oGrid whose center is within
+   dRadius of (dX, dY), passing the item, the distance between the two
+   centers and pvExtra, in no particular order.  Only the cells under the
+   square around that circle are looked at.  It is a checked runtime error
+   for oGrid or pfFound to be NULL or for dRadius to be negative. */
+void Grid_mapWithin(Grid_T oGrid, double dX, double dY, double dRadius,
+                    void (*pfFound)(void* pvItem, double dDistance,
+                                    void* pvExtra),
+                    void* pvExtra) {
+   struct Bucket* poBucket;
+   struct Entry* poEntry;
+   double dDX, dDY;
+   int iMinX, iMinY, iMaxX, iMaxY, x, y, i;
+
+   assert(oGrid != NULL && pfFound != NULL && dRadius >= 0);
+
+   iMinX = Grid_cell(oGrid, dX - dRadius);
+   iMinY = Grid_cell(oGrid, dY - dRadius);
+   iMaxX = Grid_cell(oGrid, dX + dRadius);
+   iMaxY = Grid_cell(oGrid, dY + dRadius);
+   for (y = iMinY; y <= iMaxY; y++) {
+      for (x = iMinX; x <= iMaxX; x++) {
+         poBucket = Grid_bucket(oGrid, x, y);
+         for (i = 0; i < poBucket->iNumCentered; i++) {
+            poEntry = &oGrid->poEntries[poBucket->piCentered[i]];
+            if (poEntry->iCellX != x || poEntry->iCellY != y)
+               continue;
+            dDX = poEntry->dX - dX;
+            dDY = poEntry->dY - dY;
+            if (dDX * dDX + dDY * dDY <= dRadius * dRadius)
+               (*pfFound)(poEntry->pvItem, sqrt(dDX * dDX + dDY * dDY),
+                          pvExtra);
+         }
+      }
+   }
+}
+
+/* Finds the iK items in oGrid whose centers are nearest (dX, dY), leaving
+   out pvSkip and anything further than dRadius away.  They go in ppvItems,
+   nearest first, with their distances in pdDistances, and how many were
+   found is returned.  Cells are looked at in rings around the one (dX, dY)
+   is in, stopping once nothing further out could be nearer, so dRadius
+   need only be big enough to bound the search.  It is a checked runtime
+   error for oGrid, ppvItems or pdDistances to be NULL, or for iK or
+   dRadius to be negative. */
+int Grid_findNearest(Grid_T oGrid, double dX, double dY, double dRadius,
+                     const void* pvSkip, int iK, void** ppvItems,
+                     double* pdDistances) {
+   struct Bucket* poBucket;
+   struct Entry* poEntry;
+   double dDX, dDY, dDistance;
+   int iCellX, iCellY, iRings, iFound = 0, d, x, y, i, j;
+
+   assert(oGrid != NULL && ppvItems != NULL && pdDistances != NULL);
+   assert(iK >= 0 && dRadius >= 0);
+   if (iK == 0)
+      return 0;
+
+   iCellX = Grid_cell(oGrid, dX);
+   iCellY = Grid_cell(oGrid, dY);
+   iRings = (int)ceil(dRadius * oGrid->dInverseCellSize);
+
+   for (d = 0; d <= iRings; d++) {
+      /* Everything in ring d is at least d - 1 cells away, so once the
+         iK found so far are within that, the search is over. */
+      if (iFound == iK && pdDistances[iK - 1] <= (d - 1) * oGrid->dCellSize)
+         break;
+
+      for (y = iCellY - d; y <= iCellY + d; y++) {
+         for (x = iCellX - d; x <= iCellX + d;
+              x += (y == iCellY - d || y == iCellY + d || d == 0)
+                   ? 1 : 2 * d) {
+            poBucket = Grid_bucket(oGrid, x, y);
+            for (i = 0; i < poBucket->iNumCentered; i++) {
+               poEntry = &oGrid->poEntries[poBucket->piCentered[i]];
+               if (poEntry->iCellX != x || poEntry->iCellY != y ||
+                   poEntry->pvItem == pvSkip)
+                  continue;
+               dDX = poEntry->dX - dX;
+               dDY = poEntry->dY - dY;
+               dDistance = sqrt(dDX * dDX + dDY * dDY);
+               if (dDistance > dRadius ||
+                   (iFound == iK && dDistance >= pdDistances[iK - 1]))
+                  continue;
+
+               /* Insert it in order, dropping the furthest if full. */
+               j = iFound < iK ? iFound++ : iK - 1;
+               for (; j > 0 && pdDistances[j - 1] > dDistance; j--) {
+                  pdDistances[j] = pdDistances[j - 1];
+                  ppvItems[j] = ppvItems[j - 1];
+               }
+               pdDistances[j] = dDistance;
+               ppvItems[j] = poEntry->pvItem;
+            }
+         }
+      }
+   }
+   return iFound;
+}
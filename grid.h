@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: grid.h defines the interface for the Grid ADT, a uniform
+ *    grid of bounding circles used to find which objects might be touching
+ *    without testing every pair, and which are near a point without testing
+ *    every object.  The queries only read the grid, so several may run at
+ *    once on different threads as long as nothing is moved meanwhile.
+ ___________________________________________________________________________*/
+
+#ifndef GRID_H
+#define GRID_H
+
+typedef struct Grid* Grid_T;
+
+/* Returns a new, empty grid whose square cells are dCellSize on a side.
+   Cells should be a little bigger than a typical object. */
+Grid_T Grid_new(double dCellSize);
+
+/* Frees all memory occupied by oGrid.  Does nothing if oGrid is NULL. */
+void Grid_free(Grid_T oGrid);
+
+/* Adds pvItem to oGrid as a circle of radius dRadius centered at (dX, dY).
+   Returns a handle for the new entry.  It is a checked runtime error for
+   oGrid to be NULL. */
+int Grid_insert(Grid_T oGrid, void* pvItem, double dX, double dY,
+                double dRadius);
+
+/* Moves entry iEntry of oGrid to be centered at (dX, dY).  Entries that stay
+   within the same cells only have their position updated.  It is a checked
+   runtime error for oGrid to be NULL or for iEntry not to be in oGrid. */
+void Grid_move(Grid_T oGrid, int iEntry, double dX, double dY);
+
+/* Removes entry iEntry from oGrid.  The handle may later be reused.  It is a
+   checked runtime error for oGrid to be NULL or for iEntry not to be in
+   oGrid. */
+void Grid_remove(Grid_T oGrid, int iEntry);
+
+/* Calls pfPair once for every pair of items in oGrid whose circles overlap,
+   passing the two items and pvExtra.  It is a checked runtime error for
+   oGrid or pfPair to be NULL. */
+void Grid_mapPairs(Grid_T oGrid,
+                   void (*pfPair)(void* pvItem1, void* pvItem2, void* pvExtra),
+                   void* pvExtra);
+
+/* Calls pfFound once for every item in oGrid whose center is within
+   dRadius of (dX, dY), passing the item, the distance between the two
+   centers and pvExtra, in no particular order.  Only the cells under the
+   square around that circle are looked at.  It is a checked runtime error
+   for oGrid or pfFound to be NULL or for dRadius to be negative. */
+void Grid_mapWithin(Grid_T oGrid, double dX, double dY, double dRadius,
+                    void (*pfFound)(void* pvItem, double dDistance,
+                                    void* pvExtra),
+                    void* pvExtra);
+
+/* Finds the iK items in oGrid whose centers are nearest (dX, dY), leaving
+   out pvSkip and anything further than dRadius away.  They go in ppvItems,
+   nearest first, with their distances in pdDistances, and how many were
+   found is returned.  Cells are looked at in rings around the one (dX, dY)
+   is in, stopping once nothing further out could be nearer, so dRadius
+   need only be big enough to bound the search.  It is a checked runtime
+   error for oGrid, ppvItems or pdDistances to be NULL, or for iK or
+   dRadius to be negative. */
+int Grid_findNearest(Grid_T oGrid, double dX, double dY, double dRadius,
+                     const void* pvSkip, int iK, void** ppvItems,
+                     double* pdDistances);
+
+#endif
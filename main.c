@@ -24,6 +24,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <math.h>
 #include "draw.h"
 #include "rect.h"
@@ -31,99 +33,220 @@
 #include "ship.h"
 #include "particlesys.h"
 #include "timer.h"
+#include "render.h"
+#include "dump.h"
+#include "world.h"
 
 #include <SDL.h>
 
 #define FPS 100
+#define MAX_STEPS 5  /* Most simulation steps run before drawing a frame. */
+#define SCENE_SEED 1
+#define RENDER_THREADS 4  /* Threads that draw each frame. */
+#define WORLD_THREADS 4   /* Threads that step the ships. */
+#define SCREEN_DEPTH 32
+#define HEADLESS_FRAMES 1000
+#define HEADLESS_AI_SHIPS 2
+#define HEADLESS_SPACING 1000
+#define HEADLESS_ROW 32
+#define OFFSCREEN_WIDTH 800
+#define OFFSCREEN_HEIGHT 600
 
 Color_T black;
 Color_T white;
 
-void DrawScene(Ship_T oShip, Ship_T oShip2, Ship_T oShip3)
+void DrawScene(World_T oWorld, WorldId_T oPlayer, double dBlend)
 {
-   Draw_lockScreen();
-
-   Draw_clearScreen();
    /*  for(x = -50; x < 50; x++)
        for(y = -50; y < 50; y++)
-       Draw_drawScaledPixel(x*150, y*150, white);
+       Vec2_draw(Vec2_make(x*150, y*150), white);
    */
-   Ship_applyVelocities(oShip);
-   Ship_applyVelocities(oShip2);
-   Ship_applyVelocities(oShip3);
-   Ship_centerWindow(oShip);
-   Ship_draw(oShip);
-   Ship_draw(oShip2);
-   Ship_draw(oShip3);/*
-                       Vector_drawBetween(Ship_getCenter(oShip), Ship_getCenter(oShip2), white);
-                       Vector_drawBetween(Ship_getCenter(oShip), Ship_getCenter(oShip3), white);*/
+   Ship_centerWindow(World_getShip(oWorld, oPlayer), dBlend);
+   World_draw(oWorld, dBlend);
+
+   /* Everything above was only recorded.  Show the frame the render thread
+      drew while it was, and have it draw this one while the next is. */
+   Render_finish();
    Draw_flipScreen();
-   Draw_unlockScreen();
+   Render_submit();
+}
+
+/* Runs iFrames frames with no display and a synthetic clock, with iNumAI
+   ships following a scripted player ship, then reports how long it took.
+   Frames go by as fast as the CPU allows.  If isOffscreen, every frame is
+   drawn into memory, and written to pcDump too unless it is NULL; a
+   pcDump ending in .raw gets raw pixels and any other PPM. */
+int RunHeadless(int iFrames, int iNumAI, int isOffscreen, const char* pcDump)
+{
+   World_T oWorld;
+   WorldId_T oPlayer;
+   Ship_T oShip;
+   Dump_T oDump = NULL;
+   clock_t iStart;
+   double dSeconds, dBlend;
+   int i, f, s, iSteps;
+
+   if (isOffscreen)
+      Draw_initMemory(OFFSCREEN_WIDTH, OFFSCREEN_HEIGHT);
+   else
+      Draw_initHeadless();
+   if (pcDump != NULL) {
+      i = strlen(pcDump);
+      oDump = Dump_new(pcDump, i > 4 && strcmp(pcDump + i - 4, ".raw") == 0
+                               ? DUMP_RAW : DUMP_PPM);
+      if (oDump == NULL) {
+         fprintf(stderr, "Unable to write frames to %s\n", pcDump);
+         return 1;
+      }
+   }
+   Timer_initSynthetic(FPS);
+   Ship_seed(SCENE_SEED);
+
+   oWorld = World_new();
+   World_setThreads(oWorld, WORLD_THREADS);
+   oPlayer = World_spawn(oWorld, Ship_new("ship_xwingjr"));
+   for (i = 0; i < iNumAI; i++) {
+      oShip = Ship_new("ship_xwing");
+      Ship_translate(oShip,
+                     HEADLESS_SPACING * (i % HEADLESS_ROW - HEADLESS_ROW / 2),
+                     HEADLESS_SPACING * (i / HEADLESS_ROW + 1));
+      World_spawn(oWorld, oShip);
+   }
+
+   iStart = clock();
+   for (f = 0; f < iFrames; f++) {
+      Timer_advance(1000 / FPS);
+      iSteps = Timer_startFrame(MAX_STEPS);
+      for (s = 0; s < iSteps; s++) {
+         /* The player flies straight, turning now and then. */
+         if (f % 200 < 150)
+            Ship_fullThrottle(World_getShip(oWorld, oPlayer));
+         else
+            Ship_fullLeftThrottle(World_getShip(oWorld, oPlayer));
+         World_step(oWorld, oPlayer, Timer_getStep());
+      }
+
+      dBlend = Timer_getBlend();
+      Ship_centerWindow(World_getShip(oWorld, oPlayer), dBlend);
+      World_draw(oWorld, dBlend);
+
+      /* Write the frame before this one, which the render thread has been
+         drawing meanwhile. */
+      Render_finish();
+      if (f > 0 && oDump != NULL && !Dump_frame(oDump)) {
+         fprintf(stderr, "Unable to write frame %d to %s\n", f - 1, pcDump);
+         break;
+      }
+      Render_submit();
+   }
+   Render_finish();
+   if (f == iFrames && f > 0 && oDump != NULL && !Dump_frame(oDump))
+      fprintf(stderr, "Unable to write frame %d to %s\n", f - 1, pcDump);
+   dSeconds = (double)(clock() - iStart) / CLOCKS_PER_SEC;
+   Dump_free(oDump);
+
+   /* Keep the report out of frames going to the standard output. */
+   fprintf(pcDump != NULL && strcmp(pcDump, "-") == 0 ? stderr : stdout,
+           "%d frames of %d ships in %.3f s (%.1f frames/s)\n", f,
+           iNumAI + 1, dSeconds, dSeconds > 0 ? f / dSeconds : 0.0);
+
+   Render_quit();
+   World_free(oWorld);
+   return 0;
 }
 
 int main(int argc, char *argv[])
 {
    int done=0;
-   Ship_T oShip, oShip2, oShip3;
-
-   Draw_init();
+   int s, iSteps, isOffscreen;
+   World_T oWorld;
+   WorldId_T oPlayer;
+   Ship_T oShip;
+
+   /* ./game -headless [frames [ai ships]] runs without a display, and
+      ./game -offscreen [frames [ai ships [dump file]]] draws into memory. */
+   isOffscreen = argc > 1 && strcmp(argv[1], "-offscreen") == 0;
+   if (isOffscreen || (argc > 1 && strcmp(argv[1], "-headless") == 0))
+      return RunHeadless(argc > 2 ? atoi(argv[2]) : HEADLESS_FRAMES,
+                         argc > 3 ? atoi(argv[3]) : HEADLESS_AI_SHIPS,
+                         isOffscreen,
+                         isOffscreen && argc > 4 ? argv[4] : NULL);
+
+   /* ./game -mode width height [downscale [depth]] picks the screen. */
+   if (argc > 3 && strcmp(argv[1], "-mode") == 0)
+      Draw_initMode(atoi(argv[2]), atoi(argv[3]),
+                    argc > 5 ? atoi(argv[5]) : SCREEN_DEPTH,
+                    argc > 4 ? atoi(argv[4]) : 1);
+   else
+      Draw_init();
+   Render_setThreads(RENDER_THREADS);
    Timer_init(FPS);
+   Ship_seed(SCENE_SEED);
 
    black = Draw_getColor(0,0,0);
    white = Draw_getColor((unsigned char)255,
                          (unsigned char)255,
                          (unsigned char)255);
 
-   oShip = Ship_new("ship_xwingjr");
-   oShip2 = Ship_new("ship_xwing");
-   oShip3 = Ship_new("ship_xwing");
-
-   Ship_translate(oShip2, 1000, 1000);
-   Ship_translate(oShip3, -100, -100);
+   /* The player, and two ships that chase whichever ship the player
+      flies. */
+   oWorld = World_new();
+   World_setThreads(oWorld, WORLD_THREADS);
+   oPlayer = World_spawn(oWorld, Ship_new("ship_xwingjr"));
+   oShip = Ship_new("ship_xwing");
+   Ship_translate(oShip, 1000, 1000);
+   World_spawn(oWorld, oShip);
+   oShip = Ship_new("ship_xwing");
+   Ship_translate(oShip, -100, -100);
+   World_spawn(oWorld, oShip);
 
    while(done == 0)
    {
       SDL_Event event;
       Uint8 *keystate = SDL_GetKeyState(NULL);
       if (keystate[SDLK_ESCAPE]) done = 1;
-      if (keystate[SDLK_UP])
-         Ship_fullThrottle(oShip);
-      else {
-         if (keystate[SDLK_RIGHT])
-            Ship_fullLeftThrottle(oShip);
-         if (keystate[SDLK_LEFT])
-            Ship_fullRightThrottle(oShip);
-      }
-      Ship_followRotation(oShip3, oShip);
-      Ship_followPosition(oShip3, oShip);
-      Ship_followRotation(oShip2, oShip);
-      Ship_followPosition(oShip2, oShip);
-
-/*   if(Ship_doIntersect(oShip2, oShip3)) {
-     Ship_T temp = oShip;
-     oShip = oShip2;
-     oShip2 = temp;
-     }
+
+      /* Every ship steps by the same fixed amount, as many times as the
+         clock says is due.  The keys held this frame apply to every step. */
+      iSteps = Timer_startFrame(MAX_STEPS);
+      for (s = 0; s < iSteps; s++) {
+         oShip = World_getShip(oWorld, oPlayer);
+         if (keystate[SDLK_UP])
+            Ship_fullThrottle(oShip);
+         else {
+            if (keystate[SDLK_RIGHT])
+               Ship_fullLeftThrottle(oShip);
+            if (keystate[SDLK_LEFT])
+               Ship_fullRightThrottle(oShip);
+         }
+         if (keystate[SDLK_DOWN])
+            Ship_stopSlow(oShip);
+
+/*      if(Ship_doIntersect(oShip2, oShip3)) {
+        Ship_T temp = oShip;
+        oShip = oShip2;
+        oShip2 = temp;
+        }
 */
-      if (keystate[SDLK_DOWN])
-         Ship_stopSlow(oShip);
+         World_step(oWorld, oPlayer, Timer_getStep());
+      }
       while ( SDL_PollEvent(&event) )
       {
          if ( event.type == SDL_QUIT )  done = 1;
          if ( event.type == SDL_KEYDOWN )
-            if ( event.key.keysym.sym == SDLK_SPACE ) {
-               Ship_T temp = oShip;
-               oShip = oShip2;
-               oShip2 = temp;
-            }
+            if ( event.key.keysym.sym == SDLK_SPACE )
+               /* Take over the next ship along. */
+               oPlayer = World_getIdAt(oWorld,
+                                       (World_getIndex(oWorld, oPlayer) + 1) %
+                                       World_getNumShips(oWorld));
 
       }
 
-      DrawScene(oShip, oShip2, oShip3);
+      DrawScene(oWorld, oPlayer, Timer_getBlend());
    }
+   Render_quit();
 
-   Ship_free(oShip);
-   Ship_free(oShip2);
+   World_free(oWorld);
    return 0;
 }
 
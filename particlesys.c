@@ -31,40 +31,62 @@
 
 #include "draw.h"
 #include "particlesys.h"
+#include "render.h"
 #include <assert.h>
 #include <stdlib.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 /* Structure to store the systems datatype. */
 struct ParticleSys {
-       /* Array of points. [iCount][2], where the 2 is x and y */
-       double* pdPointArray;
+       /* Positions, velocities and ages, each in its own array so they can
+          be updated several at a time. */
+       float* pfX;
+       float* pfY;
+       float* pfVX;
+       float* pfVY;
+       float* pfAge;
 
-       /* Number of points. */
+       /* Number of slots. */
        int iNum;
 
-       /* Number of used slots. */
+       /* The particles in use are a ring of iNumUsed slots starting at
+          iFirst.  They all live equally long and are added in order, so the
+          oldest is always at iFirst. */
+       int iFirst;
        int iNumUsed;
 
+       /* How old a particle gets before it goes. */
+       float fLifetime;
+
        /* Color. */
        Color_T iColor;
        };
 
 
-/* Creates a new system of iCount particles, with color iCol. */
-ParticleSys_T ParticleSys_new(int iCount, Color_T iCol) {
+/* Creates a new system of iCount particles, with color iCol.  Particles are
+   removed once they are dLifetime old. */
+ParticleSys_T ParticleSys_new(int iCount, Color_T iCol, double dLifetime) {
    ParticleSys_T oNewSys;
 
    oNewSys = (ParticleSys_T)malloc(sizeof(struct ParticleSys));
    assert(oNewSys != NULL);
 
    oNewSys->iColor = iCol;
-   oNewSys->iNum = iCount;
+   oNewSys->iNum = iCount > 0 ? iCount : 0;
+   oNewSys->iFirst = 0;
    oNewSys->iNumUsed = 0;
+   oNewSys->fLifetime = (float)dLifetime;
 
-   /* Note the constant 2 here is legit because that is the number of
-      dimensions needed to represent a point. */
-   oNewSys->pdPointArray = (double*)malloc(iCount * 2 * sizeof(double));
-   assert(oNewSys->pdPointArray != NULL);
+   /* One block holds all five arrays. */
+   oNewSys->pfX = (float*)malloc((oNewSys->iNum * 5 + 1) * sizeof(float));
+   assert(oNewSys->pfX != NULL);
+   oNewSys->pfY = oNewSys->pfX + oNewSys->iNum;
+   oNewSys->pfVX = oNewSys->pfY + oNewSys->iNum;
+   oNewSys->pfVY = oNewSys->pfVX + oNewSys->iNum;
+   oNewSys->pfAge = oNewSys->pfVY + oNewSys->iNum;
 
    return oNewSys;
 }
@@ -73,51 +95,200 @@ ParticleSys_T ParticleSys_new(int iCount, Color_T iCol) {
 void ParticleSys_free(ParticleSys_T oPSys) {
    if (oPSys == NULL)
       return;
-   free(oPSys->pdPointArray);
+   free(oPSys->pfX);
    free(oPSys);
 }
 
-/* Adds a particle at point (dX, dY) to oPSys.  It is a checked runtime error
-   for oPSys to be NULL. */
-void ParticleSys_add(ParticleSys_T oPSys, double dX, double dY) {
+/* Adds a particle at point (dX, dY) moving at (dVX, dVY) to oPSys.  If oPSys
+   is full its oldest particle makes way.  It is a checked runtime error for
+   oPSys to be NULL. */
+void ParticleSys_add(ParticleSys_T oPSys, double dX, double dY, double dVX,
+                     double dVY) {
    int pos;
    assert(oPSys != NULL);
 
-   if(oPSys->iNumUsed < oPSys->iNum) {
-      oPSys->pdPointArray[2 * oPSys->iNumUsed] = dX;
-      oPSys->pdPointArray[2 * oPSys->iNumUsed + 1] = dY;
-      oPSys->iNumUsed++;
+   if (oPSys->iNum == 0)
       return;
-   }
-   pos = (int)((double)rand() / (RAND_MAX) * oPSys->iNum);
-   oPSys->pdPointArray[2 * pos] = dX;
-   oPSys->pdPointArray[2 * pos + 1] = dY;
+   if (oPSys->iNumUsed == oPSys->iNum)
+      ParticleSys_decay(oPSys);
+
+   pos = oPSys->iFirst + oPSys->iNumUsed;
+   if (pos >= oPSys->iNum)
+      pos -= oPSys->iNum;
+   oPSys->pfX[pos] = (float)dX;
+   oPSys->pfY[pos] = (float)dY;
+   oPSys->pfVX[pos] = (float)dVX;
+   oPSys->pfVY[pos] = (float)dVY;
+   oPSys->pfAge[pos] = 0;
+   oPSys->iNumUsed++;
 }
 
-/* Removes a random particle from oPSys.  It is a checked runtime error for
+/* Removes the oldest particle from oPSys.  It is a checked runtime error for
    oPSys to be NULL. */
 void ParticleSys_decay(ParticleSys_T oPSys) {
-   int pos, num;
    assert(oPSys != NULL);
 
-   num = oPSys->iNumUsed - 1;
-   if (num < 0) return;
-   pos = (int)(rand() * num / RAND_MAX );
-
-   oPSys->pdPointArray[2 * pos] = oPSys->pdPointArray[2 * num];
-   oPSys->pdPointArray[2 * pos + 1] = oPSys->pdPointArray[2 * num + 1];
+   if (oPSys->iNumUsed == 0)
+      return;
+   if (++oPSys->iFirst == oPSys->iNum)
+      oPSys->iFirst = 0;
    oPSys->iNumUsed--;
+}
+
+/* Removes the iCount oldest particles from oPSys, or all of them if it has
+   fewer.  It is a checked runtime error for oPSys to be NULL. */
+void ParticleSys_decayMany(ParticleSys_T oPSys, int iCount) {
+   assert(oPSys != NULL);
 
+   if (iCount <= 0)
+      return;
+   if (iCount >= oPSys->iNumUsed) {
+      oPSys->iFirst = 0;
+      oPSys->iNumUsed = 0;
+      return;
+   }
+   oPSys->iFirst += iCount;
+   if (oPSys->iFirst >= oPSys->iNum)
+      oPSys->iFirst -= oPSys->iNum;
+   oPSys->iNumUsed -= iCount;
 }
 
-/* Draws oPSys to the screen.  It is a checked runtime error for oPSys to
-   be NULL. */
-void ParticleSys_draw(ParticleSys_T oPSys) {
-   int i;
+/* In house function for moving and ageing the iCount particles of oPSys
+   from slot iStart by time fT. */
+static void ParticleSys_updateSpan(ParticleSys_T oPSys, int iStart,
+                                   int iCount, float fT) {
+   float* pfX = oPSys->pfX + iStart;
+   float* pfY = oPSys->pfY + iStart;
+   float* pfVX = oPSys->pfVX + iStart;
+   float* pfVY = oPSys->pfVY + iStart;
+   float* pfAge = oPSys->pfAge + iStart;
+   int i = 0;
+
+#if defined(__SSE__)
+   {
+      __m128 vT = _mm_set1_ps(fT);
+      for (; i + 4 <= iCount; i += 4) {
+         _mm_storeu_ps(pfX + i, _mm_add_ps(_mm_loadu_ps(pfX + i),
+                                           _mm_mul_ps(_mm_loadu_ps(pfVX + i),
+                                                      vT)));
+         _mm_storeu_ps(pfY + i, _mm_add_ps(_mm_loadu_ps(pfY + i),
+                                           _mm_mul_ps(_mm_loadu_ps(pfVY + i),
+                                                      vT)));
+         _mm_storeu_ps(pfAge + i, _mm_add_ps(_mm_loadu_ps(pfAge + i), vT));
+      }
+   }
+#endif
+   for (; i < iCount; i++) {
+      pfX[i] += pfVX[i] * fT;
+      pfY[i] += pfVY[i] * fT;
+      pfAge[i] += fT;
+   }
+}
+
+/* Moves and ages every particle of oPSys by time dT, and removes those
+   that have outlived the system's lifetime.  It is a checked runtime error
+   for oPSys to be NULL. */
+void ParticleSys_update(ParticleSys_T oPSys, double dT) {
+   int iEnd;
    assert(oPSys != NULL);
-   for(i = 0; i < oPSys->iNumUsed; i++) {
-      Draw_drawScaledPixel(oPSys->pdPointArray[2 * i],
-                           oPSys->pdPointArray[2 * i + 1], oPSys->iColor);
+
+   iEnd = oPSys->iFirst + oPSys->iNumUsed;
+   if (iEnd <= oPSys->iNum)
+      ParticleSys_updateSpan(oPSys, oPSys->iFirst, oPSys->iNumUsed,
+                             (float)dT);
+   else {
+      ParticleSys_updateSpan(oPSys, oPSys->iFirst,
+                             oPSys->iNum - oPSys->iFirst, (float)dT);
+      ParticleSys_updateSpan(oPSys, 0, iEnd - oPSys->iNum, (float)dT);
+   }
+
+   /* The oldest are first, so only the front of the ring can expire. */
+   while (oPSys->iNumUsed > 0 &&
+          oPSys->pfAge[oPSys->iFirst] >= oPSys->fLifetime)
+      ParticleSys_decay(oPSys);
+}
+
+/* Returns the number of particles in oPSys.  It is a checked runtime error
+   for oPSys to be NULL. */
+int ParticleSys_getCount(ParticleSys_T oPSys) {
+   assert(oPSys != NULL);
+   return oPSys->iNumUsed;
+}
+
+/* In house function for growing the box pfBox (min x, min y, max x, max y)
+   to take in the iCount particles of oPSys from slot iStart. */
+static void ParticleSys_growBox(ParticleSys_T oPSys, int iStart, int iCount,
+                                float* pfBox) {
+   const float* pfX = oPSys->pfX + iStart;
+   const float* pfY = oPSys->pfY + iStart;
+   int i = 0;
+
+#if defined(__SSE__)
+   if (iCount >= 4) {
+      __m128 vMinX = _mm_set1_ps(pfBox[0]), vMinY = _mm_set1_ps(pfBox[1]);
+      __m128 vMaxX = _mm_set1_ps(pfBox[2]), vMaxY = _mm_set1_ps(pfBox[3]);
+      float afMinX[4], afMinY[4], afMaxX[4], afMaxY[4];
+      int j;
+
+      for (; i + 4 <= iCount; i += 4) {
+         vMinX = _mm_min_ps(vMinX, _mm_loadu_ps(pfX + i));
+         vMaxX = _mm_max_ps(vMaxX, _mm_loadu_ps(pfX + i));
+         vMinY = _mm_min_ps(vMinY, _mm_loadu_ps(pfY + i));
+         vMaxY = _mm_max_ps(vMaxY, _mm_loadu_ps(pfY + i));
+      }
+      _mm_storeu_ps(afMinX, vMinX);
+      _mm_storeu_ps(afMinY, vMinY);
+      _mm_storeu_ps(afMaxX, vMaxX);
+      _mm_storeu_ps(afMaxY, vMaxY);
+      for (j = 0; j < 4; j++) {
+         if (afMinX[j] < pfBox[0]) pfBox[0] = afMinX[j];
+         if (afMinY[j] < pfBox[1]) pfBox[1] = afMinY[j];
+         if (afMaxX[j] > pfBox[2]) pfBox[2] = afMaxX[j];
+         if (afMaxY[j] > pfBox[3]) pfBox[3] = afMaxY[j];
+      }
+   }
+#endif
+   for (; i < iCount; i++) {
+      if (pfX[i] < pfBox[0]) pfBox[0] = pfX[i];
+      if (pfY[i] < pfBox[1]) pfBox[1] = pfY[i];
+      if (pfX[i] > pfBox[2]) pfBox[2] = pfX[i];
+      if (pfY[i] > pfBox[3]) pfBox[3] = pfY[i];
    }
 }
 
+/* Records oPSys to be drawn this frame, unless all of it is off the screen.
+   It is a checked runtime error for oPSys to be NULL. */
+void ParticleSys_draw(ParticleSys_T oPSys) {
+   float afBox[4];
+   int iEnd;
+   assert(oPSys != NULL);
+
+   if (oPSys->iNumUsed == 0)
+      return;
+
+   /* Skip the whole system if its bounding box is off the screen; that
+      costs far less than recording every point for the renderer to drop. */
+   afBox[0] = afBox[2] = oPSys->pfX[oPSys->iFirst];
+   afBox[1] = afBox[3] = oPSys->pfY[oPSys->iFirst];
+   iEnd = oPSys->iFirst + oPSys->iNumUsed;
+   if (iEnd <= oPSys->iNum)
+      ParticleSys_growBox(oPSys, oPSys->iFirst, oPSys->iNumUsed, afBox);
+   else {
+      ParticleSys_growBox(oPSys, oPSys->iFirst, oPSys->iNum - oPSys->iFirst,
+                          afBox);
+      ParticleSys_growBox(oPSys, 0, iEnd - oPSys->iNum, afBox);
+   }
+   if (!Draw_isVisible(afBox[0], afBox[1], afBox[2], afBox[3]))
+      return;
+
+   if (iEnd <= oPSys->iNum)
+      Render_points(oPSys->pfX + oPSys->iFirst, oPSys->pfY + oPSys->iFirst,
+                    oPSys->iNumUsed, oPSys->iColor, RENDER_LAYER_EFFECTS);
+   else {
+      Render_points(oPSys->pfX + oPSys->iFirst, oPSys->pfY + oPSys->iFirst,
+                    oPSys->iNum - oPSys->iFirst, oPSys->iColor,
+                    RENDER_LAYER_EFFECTS);
+      Render_points(oPSys->pfX, oPSys->pfY, iEnd - oPSys->iNum,
+                    oPSys->iColor, RENDER_LAYER_EFFECTS);
+   }
+}
@@ -36,22 +36,38 @@
 
 typedef struct ParticleSys* ParticleSys_T;
 
-/* Creates a new system of iCount particles, with color iCol. */
-ParticleSys_T ParticleSys_new(int iCount, Color_T iCol);
+/* Creates a new system of iCount particles, with color iCol.  Particles are
+   removed once they are dLifetime old. */
+ParticleSys_T ParticleSys_new(int iCount, Color_T iCol, double dLifetime);
 
 /* Frees all memory occupied by oPSys.  Does nothing if oPSys is NULL. */
 void ParticleSys_free(ParticleSys_T oPSys);
 
-/* Adds a particle at point (dX, dY) to oPSys.  It is a checked runtime error
-   for oPSys to be NULL. */
-void ParticleSys_add(ParticleSys_T oPSys, double dX, double dY);
+/* Adds a particle at point (dX, dY) moving at (dVX, dVY) to oPSys.  If oPSys
+   is full its oldest particle makes way.  It is a checked runtime error for
+   oPSys to be NULL. */
+void ParticleSys_add(ParticleSys_T oPSys, double dX, double dY, double dVX,
+                     double dVY);
 
-/* Removes a random particle from oPSys.  It is a checked runtime error for
+/* Removes the oldest particle from oPSys.  It is a checked runtime error for
    oPSys to be NULL. */
 void ParticleSys_decay(ParticleSys_T oPSys);
 
-/* Draws oPSys to the screen.  It is a checked runtime error for oPSys to
-   be NULL. */
+/* Removes the iCount oldest particles from oPSys, or all of them if it has
+   fewer.  It is a checked runtime error for oPSys to be NULL. */
+void ParticleSys_decayMany(ParticleSys_T oPSys, int iCount);
+
+/* Moves and ages every particle of oPSys by time dT, and removes those
+   that have outlived the system's lifetime.  It is a checked runtime error
+   for oPSys to be NULL. */
+void ParticleSys_update(ParticleSys_T oPSys, double dT);
+
+/* Returns the number of particles in oPSys.  It is a checked runtime error
+   for oPSys to be NULL. */
+int ParticleSys_getCount(ParticleSys_T oPSys);
+
+/* Records oPSys to be drawn this frame, unless all of it is off the screen.
+   It is a checked runtime error for oPSys to be NULL. */
 void ParticleSys_draw(ParticleSys_T oPSys);
 
 #endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: pid.c defines the implementation for the Pid ADT.  Gains
+ *    and error histories are kept in separate arrays, one entry for each
+ *    controller, so a run of controllers is one flat loop.
+ ___________________________________________________________________________*/
+
+#include "pid.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define INITIAL_CAPACITY 8
+
+/* Structure to store the set of controllers. */
+struct Pid {
+       double* pdKP;
+       double* pdKI;
+       double* pdKD;
+       double* pdLastError;
+       double* pdLastLastError;
+       int iCount;
+       int iCapacity;
+       };
+
+/* Returns gains of dKP, dKI and dKD. */
+PidGains_T PidGains_make(double dKP, double dKI, double dKD) {
+   PidGains_T oGains;
+   oGains.dKP = dKP;
+   oGains.dKI = dKI;
+   oGains.dKD = dKD;
+   return oGains;
+}
+
+/* Returns a new, empty set of controllers. */
+Pid_T Pid_new(void) {
+   Pid_T oNewPid = (Pid_T)malloc(sizeof(struct Pid));
+   assert(oNewPid != NULL);
+
+   oNewPid->pdKP = NULL;
+   oNewPid->pdKI = NULL;
+   oNewPid->pdKD = NULL;
+   oNewPid->pdLastError = NULL;
+   oNewPid->pdLastLastError = NULL;
+   oNewPid->iCount = 0;
+   oNewPid->iCapacity = 0;
+   return oNewPid;
+}
+
+/* Frees all memory occupied by oPid.  Does nothing if oPid is NULL. */
+void Pid_free(Pid_T oPid) {
+   if (oPid == NULL)
+      return;
+   free(oPid->pdKP);
+   free(oPid->pdKI);
+   free(oPid->pdKD);
+   free(oPid->pdLastError);
+   free(oPid->pdLastLastError);
+   free(oPid);
+}
+
+/* Adds a controller with gains oGains and no errors yet to oPid, and
+   returns its number, which is how many it had before.  It is a checked
+   runtime error for oPid to be NULL. */
+int Pid_add(Pid_T oPid, PidGains_T oGains) {
+   int i;
+
+   assert(oPid != NULL);
+   if (oPid->iCount == oPid->iCapacity) {
+      oPid->iCapacity = oPid->iCapacity ? 2 * oPid->iCapacity
+                                        : INITIAL_CAPACITY;
+      oPid->pdKP = (double*)realloc(oPid->pdKP,
+                                    oPid->iCapacity * sizeof(double));
+      oPid->pdKI = (double*)realloc(oPid->pdKI,
+                                    oPid->iCapacity * sizeof(double));
+      oPid->pdKD = (double*)realloc(oPid->pdKD,
+                                    oPid->iCapacity * sizeof(double));
+      oPid->pdLastError = (double*)realloc(oPid->pdLastError,
+                                           oPid->iCapacity * sizeof(double));
+      oPid->pdLastLastError = (double*)realloc(oPid->pdLastLastError,
+                                               oPid->iCapacity *
+                                               sizeof(double));
+      assert(oPid->pdKP != NULL && oPid->pdKI != NULL &&
+             oPid->pdKD != NULL && oPid->pdLastError != NULL &&
+             oPid->pdLastLastError != NULL);
+   }
+
+   i = oPid->iCount++;
+   oPid->pdKP[i] = oGains.dKP;
+   oPid->pdKI[i] = oGains.dKI;
+   oPid->pdKD[i] = oGains.dKD;
+   oPid->pdLastError[i] = 0;
+   oPid->pdLastLastError[i] = 0;
+   return i;
+}
+
+/* Removes controller i from oPid.  The last controller takes its number,
+   just as the last ship in a world takes the place of one despawned.  It
+   is a checked runtime error for oPid to be NULL or for i not to be one of
+   its controllers. */
+void Pid_remove(Pid_T oPid, int i) {
+   int iLast;
+
+   assert(oPid != NULL);
+   assert(0 <= i && i < oPid->iCount);
+   iLast = --oPid->iCount;
+   oPid->pdKP[i] = oPid->pdKP[iLast];
+   oPid->pdKI[i] = oPid->pdKI[iLast];
+   oPid->pdKD[i] = oPid->pdKD[iLast];
+   oPid->pdLastError[i] = oPid->pdLastError[iLast];
+   oPid->pdLastLastError[i] = oPid->pdLastLastError[iLast];
+}
+
+/* Returns how many controllers oPid has.  It is a checked runtime error
+   for oPid to be NULL. */
+int Pid_getCount(Pid_T oPid) {
+   assert(oPid != NULL);
+   return oPid->iCount;
+}
+
+/* Runs controllers iFirst up to iFirst + iCount of oPid, controller
+   iFirst + i being fed error pdError[i] over a step of pdTime[i] and
+   putting its correction in pdCorrection[i].  Each then remembers its
+   error for next time.  Controllers outside the range are not touched, so
+   separate ranges may be run at once on different threads.  It is a
+   checked runtime error for oPid or the arrays to be NULL, or for the
+   range not to be within oPid's controllers. */
+void Pid_update(Pid_T oPid, int iFirst, int iCount, const double* pdError,
+                const double* pdTime, double* pdCorrection) {
+   const double* pdKP;
+   const double* pdKI;
+   const double* pdKD;
+   double* pdLast;
+   double* pdLastLast;
+   double dP, dI, dD;
+   int i;
+
+   assert(oPid != NULL && pdError != NULL && pdTime != NULL &&
+          pdCorrection != NULL);
+   assert(iFirst >= 0 && iCount >= 0 && iFirst + iCount <= oPid->iCount);
+
+   /* Pointers to the range keep the loop free of offsets and branches. */
+   pdKP = oPid->pdKP + iFirst;
+   pdKI = oPid->pdKI + iFirst;
+   pdKD = oPid->pdKD + iFirst;
+   pdLast = oPid->pdLastError + iFirst;
+   pdLastLast = oPid->pdLastLastError + iFirst;
+   for (i = 0; i < iCount; i++) {
+      dP = pdError[i] - pdLast[i];
+      dI = pdKI[i] * pdTime[i] * pdError[i];
+      dD = pdKD[i] / pdTime[i] * (pdError[i] - 2 * pdLast[i] +
+                                  pdLastLast[i]);
+      pdCorrection[i] = pdKP[i] * (dP + dI + dD);
+      pdLastLast[i] = pdLast[i];
+      pdLast[i] = pdError[i];
+   }
+}
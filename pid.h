@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: pid.h defines the interface for the Pid ADT, a set of PID
+ *    controllers, as found in thermostats and cruise control, that are all
+ *    run together.
+ ___________________________________________________________________________*/
+
+#ifndef PID_H
+#define PID_H
+
+typedef struct Pid* Pid_T;
+
+/* The gains of a controller.  Its correction for an error e, last error e1
+   and error before that e2, over a step of t, is
+   dKP * ((e - e1) + dKI * t * e + dKD / t * (e - 2 * e1 + e2)). */
+typedef struct PidGains {
+       double dKP;
+       double dKI;
+       double dKD;
+       } PidGains_T;
+
+/* Returns gains of dKP, dKI and dKD. */
+PidGains_T PidGains_make(double dKP, double dKI, double dKD);
+
+/* Returns a new, empty set of controllers. */
+Pid_T Pid_new(void);
+
+/* Frees all memory occupied by oPid.  Does nothing if oPid is NULL. */
+void Pid_free(Pid_T oPid);
+
+/* Adds a controller with gains oGains and no errors yet to oPid, and
+   returns its number, which is how many it had before.  It is a checked
+   runtime error for oPid to be NULL. */
+int Pid_add(Pid_T oPid, PidGains_T oGains);
+
+/* Removes controller i from oPid.  The last controller takes its number,
+   just as the last ship in a world takes the place of one despawned.  It
+   is a checked runtime error for oPid to be NULL or for i not to be one of
+   its controllers. */
+void Pid_remove(Pid_T oPid, int i);
+
+/* Returns how many controllers oPid has.  It is a checked runtime error
+   for oPid to be NULL. */
+int Pid_getCount(Pid_T oPid);
+
+/* Runs controllers iFirst up to iFirst + iCount of oPid, controller
+   iFirst + i being fed error pdError[i] over a step of pdTime[i] and
+   putting its correction in pdCorrection[i].  Each then remembers its
+   error for next time.  Controllers outside the range are not touched, so
+   separate ranges may be run at once on different threads.  It is a
+   checked runtime error for oPid or the arrays to be NULL, or for the
+   range not to be within oPid's controllers. */
+void Pid_update(Pid_T oPid, int iFirst, int iCount, const double* pdError,
+                const double* pdTime, double* pdCorrection);
+
+#endif
@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: pool.c defines the implementation for the Pool ADT on top of
+ *    SDL threads.  Each thread keeps a deque of ready jobs under its own
+ *    lock and steals from the others' when it runs dry; only finishing a
+ *    job takes the pool's lock, so jobs should each be big enough to be
+ *    worth it.
+ ___________________________________________________________________________*/
+
+#include "pool.h"
+#include <SDL.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/* What each worker thread is started with. */
+struct Worker {
+       Pool_T oPool;
+       int iThread;
+       SDL_Thread* poThread;
+       };
+
+/* One thread's jobs that are ready to run, as job numbers across the whole
+   graph.  The thread pushes and pops at iBottom; other threads steal from
+   iTop, taking the jobs it would have got to last. */
+struct Deque {
+       SDL_mutex* poLock;
+       int* piJobs;
+       int iTop;
+       int iBottom;
+       };
+
+/* One phase of the graph. */
+struct Phase {
+       void (*pfJob)(int iIndex, int iThread, void* pvExtra);
+       void* pvExtra;
+       int iCount;
+       int iFirst;  /* The number of its job 0 across the whole graph. */
+       int iLeft;   /* Its jobs that have not returned yet. */
+       int iWaits;  /* How many returns each of its jobs waits for. */
+
+       /* The phases that wait for this one, and whether each waits job by
+          job or for the whole phase. */
+       int aiThen[POOL_MAX_PHASES];
+       int aisEach[POOL_MAX_PHASES];
+       int iNumThen;
+       };
+
+/* Structure to store the pool datatype. */
+struct Pool {
+       struct Worker* poWorkers;
+       int iNumWorkers;
+
+       /* Everything below is guarded by poLock.  Workers wait on poStart
+          for ulGeneration to change, and the caller waits on poDone for
+          iBusy to reach zero. */
+       SDL_mutex* poLock;
+       SDL_cond* poStart;
+       SDL_cond* poDone;
+       unsigned long ulGeneration;
+       int iBusy;
+       int iQuit;
+
+       /* The graph being built or run.  piWaiting holds how many jobs each
+          job still waits for.  ulPushed goes up whenever a job is made
+          ready, and threads with nothing to do wait on poWork for it to.
+          It and ulGeneration are only compared for equality, so they are
+          unsigned and free to wrap. */
+       struct Phase aoPhases[POOL_MAX_PHASES];
+       int iNumPhases;
+       int* piWaiting;
+       int iJobCapacity;
+       int iLeft;
+       unsigned long ulPushed;
+       int iSleeping;
+       SDL_cond* poWork;
+
+       struct Deque* poDeques; /* One for each thread, the caller first. */
+       };
+
+/* In house function for pushing job iJob onto the deque of thread
+   iThread of oPool. */
+static void Pool_push(Pool_T oPool, int iThread, int iJob) {
+   struct Deque* poDeque = &oPool->poDeques[iThread];
+   SDL_LockMutex(poDeque->poLock);
+   poDeque->piJobs[poDeque->iBottom++] = iJob;
+   SDL_UnlockMutex(poDeque->poLock);
+}
+
+/* In house function for taking a ready job for thread iThread of oPool:
+   the newest of its own, or else the oldest of the next thread along that
+   has any.  Returns -1 if no thread has one. */
+static int Pool_take(Pool_T oPool, int iThread) {
+   int iNumThreads = oPool->iNumWorkers + 1;
+   struct Deque* poDeque = &oPool->poDeques[iThread];
+   int iJob = -1, i;
+
+   SDL_LockMutex(poDeque->poLock);
+   if (poDeque->iBottom > poDeque->iTop)
+      iJob = poDeque->piJobs[--poDeque->iBottom];
+   SDL_UnlockMutex(poDeque->poLock);
+
+   for (i = 1; iJob < 0 && i < iNumThreads; i++) {
+      poDeque = &oPool->poDeques[(iThread + i) % iNumThreads];
+      SDL_LockMutex(poDeque->poLock);
+      if (poDeque->iBottom > poDeque->iTop)
+         iJob = poDeque->piJobs[poDeque->iTop++];
+      SDL_UnlockMutex(poDeque->poLock);
+   }
+   return iJob;
+}
+
+/* In house function for counting off one of the jobs job iJob of oPool
+   waits for, and pushing it onto the deque of thread iThread if that was
+   the last.  oPool's lock should be held. */
+static void Pool_ready(Pool_T oPool, int iThread, int iJob) {
+   if (--oPool->piWaiting[iJob] == 0) {
+      Pool_push(oPool, iThread, iJob);
+      oPool->ulPushed++;
+   }
+}
+
+/* In house function for counting off one wait of every job of phase
+   iPhase of oPool.  The jobs are shared out among the threads' deques, a
+   run of neighbouring jobs to each, pushed so that each thread starts at
+   the front of its run.  oPool's lock should be held. */
+static void Pool_readyAll(Pool_T oPool, int iPhase) {
+   struct Phase* poPhase = &oPool->aoPhases[iPhase];
+   int i;
+   for (i = poPhase->iCount - 1; i >= 0; i--)
+      Pool_ready(oPool, i * (oPool->iNumWorkers + 1) / poPhase->iCount,
+                 poPhase->iFirst + i);
+}
+
+/* In house function for noting, on thread iThread, that job iJob of oPool
+   has returned, and counting it off for whatever waits on it.  Jobs
+   waiting on it alone go on iThread's own deque, as they likely touch
+   what it just did.  oPool's lock should be held. */
+static void Pool_release(Pool_T oPool, int iJob, int iThread) {
+   struct Phase* poPhase = oPool->aoPhases;
+   struct Phase* poThen;
+   unsigned long ulPushed = oPool->ulPushed;
+   int i;
+
+   while (iJob >= poPhase->iFirst + poPhase->iCount)
+      poPhase++;
+
+   poPhase->iLeft--;
+   for (i = 0; i < poPhase->iNumThen; i++) {
+      poThen = &oPool->aoPhases[poPhase->aiThen[i]];
+      if (poPhase->aisEach[i])
+         Pool_ready(oPool, iThread, poThen->iFirst + iJob - poPhase->iFirst);
+      else if (poPhase->iLeft == 0)
+         Pool_readyAll(oPool, poPhase->aiThen[i]);
+   }
+
+   if (--oPool->iLeft == 0 ||
+       (oPool->ulPushed != ulPushed && oPool->iSleeping > 0))
+      SDL_CondBroadcast(oPool->poWork);
+}
+
+/* In house function for running jobs of oPool's graph on thread iThread
+   until every one of them has returned. */
+static void Pool_work(Pool_T oPool, int iThread) {
+   struct Phase* poPhase;
+   unsigned long ulSeen;
+   int iJob;
+
+   SDL_LockMutex(oPool->poLock);
+   ulSeen = oPool->ulPushed;
+   SDL_UnlockMutex(oPool->poLock);
+
+   for (;;) {
+      iJob = Pool_take(oPool, iThread);
+      if (iJob >= 0) {
+         poPhase = oPool->aoPhases;
+         while (iJob >= poPhase->iFirst + poPhase->iCount)
+            poPhase++;
+         (*poPhase->pfJob)(iJob - poPhase->iFirst, iThread,
+                           poPhase->pvExtra);
+
+         SDL_LockMutex(oPool->poLock);
+         Pool_release(oPool, iJob, iThread);
+         ulSeen = oPool->ulPushed;
+         SDL_UnlockMutex(oPool->poLock);
+         continue;
+      }
+
+      /* Nothing is ready: sleep until something is, or everything is
+         done.  A job pushed since ulSeen was read is either still on a
+         deque, so the search above saw it, or in someone's hands. */
+      SDL_LockMutex(oPool->poLock);
+      while (oPool->iLeft > 0 && oPool->ulPushed == ulSeen) {
+         oPool->iSleeping++;
+         SDL_CondWait(oPool->poWork, oPool->poLock);
+         oPool->iSleeping--;
+      }
+      ulSeen = oPool->ulPushed;
+      if (oPool->iLeft == 0) {
+         SDL_UnlockMutex(oPool->poLock);
+         return;
+      }
+      SDL_UnlockMutex(oPool->poLock);
+   }
+}
+
+/* In house function run by each worker thread. */
+static int Pool_workerMain(void* pvWorker) {
+   struct Worker* poWorker = (struct Worker*)pvWorker;
+   Pool_T oPool = poWorker->oPool;
+   unsigned long ulSeen = 0;
+
+   SDL_LockMutex(oPool->poLock);
+   for (;;) {
+      while (oPool->ulGeneration == ulSeen && !oPool->iQuit)
+         SDL_CondWait(oPool->poStart, oPool->poLock);
+      if (oPool->iQuit)
+         break;
+      ulSeen = oPool->ulGeneration;
+
+      SDL_UnlockMutex(oPool->poLock);
+      Pool_work(oPool, poWorker->iThread);
+      SDL_LockMutex(oPool->poLock);
+
+      if (--oPool->iBusy == 0)
+         SDL_CondSignal(oPool->poDone);
+   }
+   SDL_UnlockMutex(oPool->poLock);
+   return 0;
+}
+
+/* Returns a new pool with iNumWorkers worker threads.  The thread that
+   calls Pool_run works too, so a pool with no workers runs everything on
+   the caller.  It is a checked runtime error for iNumWorkers to be
+   negative. */
+Pool_T Pool_new(int iNumWorkers) {
+   Pool_T oPool;
+   int i;
+
+   assert(iNumWorkers >= 0);
+   oPool = (Pool_T)malloc(sizeof(struct Pool));
+   assert(oPool != NULL);
+
+   oPool->poLock = SDL_CreateMutex();
+   oPool->poStart = SDL_CreateCond();
+   oPool->poDone = SDL_CreateCond();
+   oPool->poWork = SDL_CreateCond();
+   assert(oPool->poLock != NULL && oPool->poStart != NULL &&
+          oPool->poDone != NULL && oPool->poWork != NULL);
+   oPool->ulGeneration = 0;
+   oPool->iBusy = 0;
+   oPool->iQuit = 0;
+   oPool->iNumPhases = 0;
+   oPool->piWaiting = NULL;
+   oPool->iJobCapacity = 0;
+   oPool->iLeft = 0;
+   oPool->ulPushed = 0;
+   oPool->iSleeping = 0;
+
+   oPool->poDeques = (struct Deque*)malloc((iNumWorkers + 1) *
+                                           sizeof(struct Deque));
+   assert(oPool->poDeques != NULL);
+   for (i = 0; i <= iNumWorkers; i++) {
+      oPool->poDeques[i].poLock = SDL_CreateMutex();
+      assert(oPool->poDeques[i].poLock != NULL);
+      oPool->poDeques[i].piJobs = NULL;
+      oPool->poDeques[i].iTop = 0;
+      oPool->poDeques[i].iBottom = 0;
+   }
+
+   oPool->iNumWorkers = iNumWorkers;
+   oPool->poWorkers = (struct Worker*)malloc((iNumWorkers + 1) *
+                                             sizeof(struct Worker));
+   assert(oPool->poWorkers != NULL);
+   for (i = 0; i < iNumWorkers; i++) {
+      oPool->poWorkers[i].oPool = oPool;
+      oPool->poWorkers[i].iThread = i + 1;
+      oPool->poWorkers[i].poThread =
+         SDL_CreateThread(Pool_workerMain, &oPool->poWorkers[i]);
+      assert(oPool->poWorkers[i].poThread != NULL);
+   }
+
+   return oPool;
+}
+
+/* Stops the workers of oPool and frees all memory it occupies.  Does
+   nothing if oPool is NULL. */
+void Pool_free(Pool_T oPool) {
+   int i;
+   if (oPool == NULL)
+      return;
+
+   SDL_LockMutex(oPool->poLock);
+   oPool->iQuit = 1;
+   SDL_CondBroadcast(oPool->poStart);
+   SDL_UnlockMutex(oPool->poLock);
+   for (i = 0; i < oPool->iNumWorkers; i++)
+      SDL_WaitThread(oPool->poWorkers[i].poThread, NULL);
+
+   for (i = 0; i <= oPool->iNumWorkers; i++) {
+      SDL_DestroyMutex(oPool->poDeques[i].poLock);
+      free(oPool->poDeques[i].piJobs);
+   }
+   free(oPool->poDeques);
+   free(oPool->piWaiting);
+   SDL_DestroyCond(oPool->poWork);
+   SDL_DestroyCond(oPool->poDone);
+   SDL_DestroyCond(oPool->poStart);
+   SDL_DestroyMutex(oPool->poLock);
+   free(oPool->poWorkers);
+   free(oPool);
+}
+
+/* Returns the number of threads that run jobs for oPool: its workers and
+   the caller.  It is a checked runtime error for oPool to be NULL. */
+int Pool_getNumThreads(Pool_T oPool) {
+   assert(oPool != NULL);
+   return oPool->iNumWorkers + 1;
+}
+
+/* Adds a phase to the graph oPool runs next, of calls to pfJob(i, iThread,
+   pvExtra) for each i from 0 up to iCount, and returns its number.  Phases
+   are numbered from 0 in the order they are added.  Unless it is made to
+   wait, each job may run as soon as the graph does.  It is a checked
+   runtime error for oPool or pfJob to be NULL, for iCount to be negative,
+   or for the graph to have POOL_MAX_PHASES phases already. */
+int Pool_addPhase(Pool_T oPool, void (*pfJob)(int iIndex, int iThread,
+                                              void* pvExtra),
+                  int iCount, void* pvExtra) {
+   struct Phase* poPhase;
+
+   assert(oPool != NULL && pfJob != NULL && iCount >= 0);
+   assert(oPool->iNumPhases < POOL_MAX_PHASES);
+   poPhase = &oPool->aoPhases[oPool->iNumPhases];
+   poPhase->pfJob = pfJob;
+   poPhase->pvExtra = pvExtra;
+   poPhase->iCount = iCount;
+   poPhase->iFirst = oPool->iNumPhases == 0 ? 0 : poPhase[-1].iFirst +
+                                                  poPhase[-1].iCount;
+   poPhase->iWaits = 0;
+   poPhase->iNumThen = 0;
+   return oPool->iNumPhases++;
+}
+
+/* In house function for making phase iPhase of oPool's next graph wait for
+   phase iBefore, job by job if isEach, or else as a whole. */
+static void Pool_addWait(Pool_T oPool, int iPhase, int iBefore, int isEach) {
+   struct Phase* poBefore;
+
+   assert(oPool != NULL);
+   assert(0 <= iBefore && iBefore < iPhase && iPhase < oPool->iNumPhases);
+   poBefore = &oPool->aoPhases[iBefore];
+   assert(poBefore->iNumThen < POOL_MAX_PHASES);
+   assert(!isEach || poBefore->iCount == oPool->aoPhases[iPhase].iCount);
+
+   /* A phase with no jobs has nothing to wait for. */
+   if (poBefore->iCount == 0)
+      return;
+   poBefore->aiThen[poBefore->iNumThen] = iPhase;
+   poBefore->aisEach[poBefore->iNumThen] = isEach;
+   poBefore->iNumThen++;
+   oPool->aoPhases[iPhase].iWaits++;
+}
+
+/* Makes no job of phase iPhase of oPool's next graph start until every job
+   of phase iBefore has returned.  It is a checked runtime error for oPool
+   to be NULL, or for iBefore not to have been added before iPhase. */
+void Pool_after(Pool_T oPool, int iPhase, int iBefore) {
+   Pool_addWait(oPool, iPhase, iBefore, 0);
+}
+
+/* Makes job i of phase iPhase of oPool's next graph wait for job i of
+   phase iBefore to return, for each i, so that the two phases overlap.  It
+   is a checked runtime error for oPool to be NULL, for iBefore not to have
+   been added before iPhase, or for the two to have different numbers of
+   jobs. */
+void Pool_afterEach(Pool_T oPool, int iPhase, int iBefore) {
+   Pool_addWait(oPool, iPhase, iBefore, 1);
+}
+
+/* Runs the graph of phases added to oPool since it last ran, on whichever
+   of oPool's threads is free, and returns once every job has returned.
+   iThread is from 0 up to Pool_getNumThreads, with 0 the caller, and no
+   two jobs run at once with the same iThread.  Each thread works through
+   its own queue of ready jobs and takes from the others' when it runs out.
+   Jobs must not run or add to a graph on the same pool.  It is a checked
+   runtime error for oPool to be NULL. */
+void Pool_runGraph(Pool_T oPool) {
+   struct Phase* poPhase;
+   int iNumJobs, i;
+
+   assert(oPool != NULL);
+   if (oPool->iNumPhases == 0)
+      return;
+   poPhase = &oPool->aoPhases[oPool->iNumPhases - 1];
+   iNumJobs = poPhase->iFirst + poPhase->iCount;
+
+   /* Every job is pushed once in all, so no deque can need more room than
+      there are jobs. */
+   if (oPool->iJobCapacity < iNumJobs) {
+      oPool->iJobCapacity = iNumJobs;
+      oPool->piWaiting = (int*)realloc(oPool->piWaiting,
+                                       iNumJobs * sizeof(int));
+      assert(oPool->piWaiting != NULL);
+      for (i = 0; i <= oPool->iNumWorkers; i++) {
+         oPool->poDeques[i].piJobs =
+            (int*)realloc(oPool->poDeques[i].piJobs, iNumJobs * sizeof(int));
+         assert(oPool->poDeques[i].piJobs != NULL);
+      }
+   }
+   for (i = 0; i <= oPool->iNumWorkers; i++) {
+      oPool->poDeques[i].iTop = 0;
+      oPool->poDeques[i].iBottom = 0;
+   }
+
+   /* Each job also waits for the graph to start, which lets the phases
+      that wait for nothing else be dealt out like any other. */
+   SDL_LockMutex(oPool->poLock);
+   for (poPhase = oPool->aoPhases;
+        poPhase < oPool->aoPhases + oPool->iNumPhases; poPhase++) {
+      poPhase->iLeft = poPhase->iCount;
+      for (i = 0; i < poPhase->iCount; i++)
+         oPool->piWaiting[poPhase->iFirst + i] = poPhase->iWaits + 1;
+   }
+   for (i = 0; i < oPool->iNumPhases; i++)
+      Pool_readyAll(oPool, i);
+   oPool->iLeft = iNumJobs;
+   if (oPool->iNumWorkers > 0 && iNumJobs > 1) {
+      oPool->iBusy = oPool->iNumWorkers;
+      oPool->ulGeneration++;
+      SDL_CondBroadcast(oPool->poStart);
+   }
+   SDL_UnlockMutex(oPool->poLock);
+
+   if (iNumJobs > 0)
+      Pool_work(oPool, 0);
+
+   SDL_LockMutex(oPool->poLock);
+   while (oPool->iBusy > 0)
+      SDL_CondWait(oPool->poDone, oPool->poLock);
+   SDL_UnlockMutex(oPool->poLock);
+   oPool->iNumPhases = 0;
+}
+
+/* Calls pfJob(i, iThread, pvExtra) once for each i from 0 up to iCount, on
+   whichever of oPool's threads is free, and returns once every call has
+   returned, as a graph of the one phase.  iThread is from 0 up to
+   Pool_getNumThreads, with 0 the caller, and no two calls run at once with
+   the same iThread.  Jobs must not call Pool_run on the same pool.  It is
+   a checked runtime error for oPool or pfJob to be NULL, or for phases to
+   have been added but not run. */
+void Pool_run(Pool_T oPool, void (*pfJob)(int iIndex, int iThread,
+                                          void* pvExtra),
+              int iCount, void* pvExtra) {
+   assert(oPool != NULL && pfJob != NULL && oPool->iNumPhases == 0);
+   if (iCount <= 0)
+      return;
+   Pool_addPhase(oPool, pfJob, iCount, pvExtra);
+   Pool_runGraph(oPool);
+}
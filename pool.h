@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: pool.h defines the interface for the Pool ADT, a fixed set
+ *    of worker threads that share out numbered jobs, either in one batch or
+ *    as a graph of phases that wait on each other.
+ ___________________________________________________________________________*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#define POOL_MAX_PHASES 8 /* The most phases a graph can have. */
+
+typedef struct Pool* Pool_T;
+
+/* Returns a new pool with iNumWorkers worker threads.  The thread that
+   calls Pool_run works too, so a pool with no workers runs everything on
+   the caller.  It is a checked runtime error for iNumWorkers to be
+   negative. */
+Pool_T Pool_new(int iNumWorkers);
+
+/* Stops the workers of oPool and frees all memory it occupies.  Does
+   nothing if oPool is NULL. */
+void Pool_free(Pool_T oPool);
+
+/* Returns the number of threads that run jobs for oPool: its workers and
+   the caller.  It is a checked runtime error for oPool to be NULL. */
+int Pool_getNumThreads(Pool_T oPool);
+
+/* Adds a phase to the graph oPool runs next, of calls to pfJob(i, iThread,
+   pvExtra) for each i from 0 up to iCount, and returns its number.  Phases
+   are numbered from 0 in the order they are added.  Unless it is made to
+   wait, each job may run as soon as the graph does.  It is a checked
+   runtime error for oPool or pfJob to be NULL, for iCount to be negative,
+   or for the graph to have POOL_MAX_PHASES phases already. */
+int Pool_addPhase(Pool_T oPool, void (*pfJob)(int iIndex, int iThread,
+                                              void* pvExtra),
+                  int iCount, void* pvExtra);
+
+/* Makes no job of phase iPhase of oPool's next graph start until every job
+   of phase iBefore has returned.  It is a checked runtime error for oPool
+   to be NULL, or for iBefore not to have been added before iPhase. */
+void Pool_after(Pool_T oPool, int iPhase, int iBefore);
+
+/* Makes job i of phase iPhase of oPool's next graph wait for job i of
+   phase iBefore to return, for each i, so that the two phases overlap.  It
+   is a checked runtime error for oPool to be NULL, for iBefore not to have
+   been added before iPhase, or for the two to have different numbers of
+   jobs. */
+void Pool_afterEach(Pool_T oPool, int iPhase, int iBefore);
+
+/* Runs the graph of phases added to oPool since it last ran, on whichever
+   of oPool's threads is free, and returns once every job has returned.
+   iThread is from 0 up to Pool_getNumThreads, with 0 the caller, and no
+   two jobs run at once with the same iThread.  Each thread works through
+   its own queue of ready jobs and takes from the others' when it runs out.
+   Jobs must not run or add to a graph on the same pool.  It is a checked
+   runtime error for oPool to be NULL. */
+void Pool_runGraph(Pool_T oPool);
+
+/* Calls pfJob(i, iThread, pvExtra) once for each i from 0 up to iCount, on
+   whichever of oPool's threads is free, and returns once every call has
+   returned, as a graph of the one phase.  iThread is from 0 up to
+   Pool_getNumThreads, with 0 the caller, and no two calls run at once with
+   the same iThread.  Jobs must not call Pool_run on the same pool.  It is
+   a checked runtime error for oPool or pfJob to be NULL, or for phases to
+   have been added but not run. */
+void Pool_run(Pool_T oPool, void (*pfJob)(int iIndex, int iThread,
+                                          void* pvExtra),
+              int iCount, void* pvExtra);
+
+#endif
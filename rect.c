@@ -31,267 +31,363 @@
 #include "rect.h"
 #include "vector.h"
 #include "draw.h"
+#include "render.h"
+#include "sat.h"
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 
-/* Structure to store the Rect datatype. */
-struct Rect {
-       double extentX;
-       double extentY;
-       double mass;
-       Vector_T objCenter; /* Center of the object the rect belongs to. */
-       Vector_T offset;    /* Offset of the rect from that center point. */
-       Vector_T axisX;     /* X-axis of the rect. */
-       Vector_T axisY;     /* Y-axis of the rect. */
-       };
+#define INITIAL_CAPACITY 64
+
+/* The rect store.  Every field of every rect lives in its own array, indexed
+   by Rect_T, so that a sweep over the rects of one ship touches a handful of
+   packed double arrays rather than chasing pointers. */
+static struct RectStore {
+       double* pdExtentX;
+       double* pdExtentY;
+       double* pdMass;
+       double* pdOffsetX; /* Offset of the rect from its object's center. */
+       double* pdOffsetY;
+       double* pdAxisXX;  /* X-axis of the rect. */
+       double* pdAxisXY;
+       double* pdAxisYX;  /* Y-axis of the rect. */
+       double* pdAxisYY;
+
+       int iSize;         /* One past the highest slot ever handed out. */
+       int iCapacity;     /* Number of slots allocated in each array. */
+
+       /* Ranges below iSize that have been freed, sorted by first slot. */
+       int* piFreeFirst;
+       int* piFreeCount;
+       int iNumFree;
+       int iFreeCapacity;
+       } oStore;
+
+/* In house function for resizing one of the store's arrays. */
+static double* Rect_growArray(double* pdArray, int iCapacity) {
+   pdArray = (double*)realloc(pdArray, iCapacity * sizeof(double));
+   assert(pdArray != NULL);
+   return pdArray;
+}
+
+/* In house function for making sure the store has at least iCapacity
+   slots. */
+static void Rect_reserve(int iCapacity) {
+   int iNew;
+
+   if (iCapacity <= oStore.iCapacity)
+      return;
+
+   iNew = oStore.iCapacity ? oStore.iCapacity : INITIAL_CAPACITY;
+   while (iNew < iCapacity)
+      iNew *= 2;
+
+   oStore.pdExtentX = Rect_growArray(oStore.pdExtentX, iNew);
+   oStore.pdExtentY = Rect_growArray(oStore.pdExtentY, iNew);
+   oStore.pdMass    = Rect_growArray(oStore.pdMass, iNew);
+   oStore.pdOffsetX = Rect_growArray(oStore.pdOffsetX, iNew);
+   oStore.pdOffsetY = Rect_growArray(oStore.pdOffsetY, iNew);
+   oStore.pdAxisXX  = Rect_growArray(oStore.pdAxisXX, iNew);
+   oStore.pdAxisXY  = Rect_growArray(oStore.pdAxisXY, iNew);
+   oStore.pdAxisYX  = Rect_growArray(oStore.pdAxisYX, iNew);
+   oStore.pdAxisYY  = Rect_growArray(oStore.pdAxisYY, iNew);
+   oStore.iCapacity = iNew;
+}
+
+/* In house function for checking that the iCount rects starting at oFirst
+   are in the store. */
+static int Rect_inStore(Rect_T oFirst, int iCount) {
+   return oFirst >= 0 && iCount >= 0 && oFirst + iCount <= oStore.iSize;
+}
+
+/* Reserves iCount contiguous rects in the store and returns the first of
+   them.  The rest are oFirst + 1 through oFirst + iCount - 1.  Each rect is
+   set up as by Rect_new(0, 0, 0).  It is a checked runtime error for iCount
+   to be less than one. */
+Rect_T Rect_newRange(int iCount) {
+   Rect_T oFirst = RECT_NONE;
+   int i;
+
+   assert(iCount >= 1);
+
+   /* Take the first freed range that is big enough... */
+   for (i = 0; i < oStore.iNumFree; i++) {
+      if (oStore.piFreeCount[i] >= iCount) {
+         oFirst = oStore.piFreeFirst[i];
+         oStore.piFreeFirst[i] += iCount;
+         oStore.piFreeCount[i] -= iCount;
+         if (oStore.piFreeCount[i] == 0) {
+            oStore.iNumFree--;
+            for (; i < oStore.iNumFree; i++) {
+               oStore.piFreeFirst[i] = oStore.piFreeFirst[i + 1];
+               oStore.piFreeCount[i] = oStore.piFreeCount[i + 1];
+            }
+         }
+         break;
+      }
+   }
+
+   /* ...or else grow the store at the end. */
+   if (oFirst == RECT_NONE) {
+      Rect_reserve(oStore.iSize + iCount);
+      oFirst = oStore.iSize;
+      oStore.iSize += iCount;
+   }
+
+   for (i = 0; i < iCount; i++)
+      Rect_init(oFirst + i, 0, 0, 0);
+
+   return oFirst;
+}
+
+/* Releases the iCount rects starting at oFirst back to the store.  Does
+   nothing if oFirst is RECT_NONE.  It is a checked runtime error for the
+   range not to have come from Rect_newRange. */
+void Rect_freeRange(Rect_T oFirst, int iCount) {
+   int i, j;
+
+   if (oFirst == RECT_NONE)
+      return;
+   assert(Rect_inStore(oFirst, iCount));
+
+   if (oStore.iNumFree == oStore.iFreeCapacity) {
+      oStore.iFreeCapacity = oStore.iFreeCapacity ? 2 * oStore.iFreeCapacity
+                                                  : INITIAL_CAPACITY;
+      oStore.piFreeFirst = (int*)realloc(oStore.piFreeFirst,
+                                         oStore.iFreeCapacity * sizeof(int));
+      oStore.piFreeCount = (int*)realloc(oStore.piFreeCount,
+                                         oStore.iFreeCapacity * sizeof(int));
+      assert(oStore.piFreeFirst != NULL && oStore.piFreeCount != NULL);
+   }
+
+   /* Insert the range in order, then merge it with its neighbours. */
+   for (i = oStore.iNumFree; i > 0 && oStore.piFreeFirst[i - 1] > oFirst; i--) {
+      oStore.piFreeFirst[i] = oStore.piFreeFirst[i - 1];
+      oStore.piFreeCount[i] = oStore.piFreeCount[i - 1];
+   }
+   oStore.piFreeFirst[i] = oFirst;
+   oStore.piFreeCount[i] = iCount;
+   oStore.iNumFree++;
+
+   if (i + 1 < oStore.iNumFree &&
+       oFirst + iCount == oStore.piFreeFirst[i + 1]) {
+      oStore.piFreeCount[i] += oStore.piFreeCount[i + 1];
+      for (j = i + 1; j < oStore.iNumFree - 1; j++) {
+         oStore.piFreeFirst[j] = oStore.piFreeFirst[j + 1];
+         oStore.piFreeCount[j] = oStore.piFreeCount[j + 1];
+      }
+      oStore.iNumFree--;
+   }
+   if (i > 0 && oStore.piFreeFirst[i - 1] + oStore.piFreeCount[i - 1] ==
+                oStore.piFreeFirst[i]) {
+      oStore.piFreeCount[i - 1] += oStore.piFreeCount[i];
+      for (j = i; j < oStore.iNumFree - 1; j++) {
+         oStore.piFreeFirst[j] = oStore.piFreeFirst[j + 1];
+         oStore.piFreeCount[j] = oStore.piFreeCount[j + 1];
+      }
+      oStore.iNumFree--;
+   }
+
+   /* A free range at the very end just shrinks the store. */
+   i = oStore.iNumFree - 1;
+   if (i >= 0 && oStore.piFreeFirst[i] + oStore.piFreeCount[i] == oStore.iSize) {
+      oStore.iSize = oStore.piFreeFirst[i];
+      oStore.iNumFree--;
+   }
+}
 
 /* Returns a new Rect_T centered at the origin with x-extent X and y-extent Y.
    The new Rect is axis-aligned to start, and (X, Y) represents the upper
    right corner of this rectangle. */
 Rect_T Rect_new(double X, double Y, double Mass) {
-   Rect_T oNewRect = (Rect_T)malloc(sizeof(struct Rect));
-   assert(oNewRect != NULL);
-   oNewRect->extentX    = X;
-   oNewRect->extentY    = Y;
-   oNewRect->mass       = Mass;
-   oNewRect->objCenter  = Vector_new(0, 0);
-   oNewRect->offset     = Vector_new(0, 0);
-   oNewRect->axisX      = Vector_new(1, 0);
-   oNewRect->axisY      = Vector_new(0, 1);
+   Rect_T oNewRect = Rect_newRange(1);
+   Rect_init(oNewRect, X, Y, Mass);
    return oNewRect;
 }
 
-/* Frees all memory occupied by oRect.  Does nothing if oRect is NULL. */
-void Rect_free(Rect_T oRect) {
-   if (oRect == NULL)
-      return;
-   Vector_free(oRect->objCenter);
-   Vector_free(oRect->offset);
-   Vector_free(oRect->axisX);
-   Vector_free(oRect->axisY);
-   free(oRect);
+/* Resets oRect to be centered at the origin with x-extent X and y-extent Y,
+   as if it had just been returned by Rect_new.  It is a checked runtime
+   error for oRect not to be in the store. */
+void Rect_init(Rect_T oRect, double X, double Y, double Mass) {
+   assert(Rect_inStore(oRect, 1));
+   oStore.pdExtentX[oRect] = X;
+   oStore.pdExtentY[oRect] = Y;
+   oStore.pdMass[oRect]    = Mass;
+   oStore.pdOffsetX[oRect] = oStore.pdOffsetY[oRect] = 0;
+   oStore.pdAxisXX[oRect]  = 1;
+   oStore.pdAxisXY[oRect]  = 0;
+   oStore.pdAxisYX[oRect]  = 0;
+   oStore.pdAxisYY[oRect]  = 1;
 }
 
-/* Draws oRect onto the screen in color iColor.  It is a checked runtime
-   error for oRect to be NULL. */
-void Rect_draw(Rect_T oRect, Color_T iColor) {
-   Vector_T upRight, upLeft, downLeft, downRight;
-   Vector_T upperHyp, lowerHyp;
-   Vector_T center;
-
-   assert(oRect != NULL);
-
-   Vector_scale(oRect->axisX, oRect->extentX);
-   Vector_scale(oRect->axisY, oRect->extentY);
-
-   center = Vector_sum(oRect->objCenter, oRect->offset);
-   upperHyp = Vector_sum(oRect->axisX, oRect->axisY);
-   lowerHyp = Vector_diff(oRect->axisX, oRect->axisY);
-
-   Vector_normalize(oRect->axisX);
-   Vector_normalize(oRect->axisY);
+/* Frees the single rect oRect.  Does nothing if oRect is RECT_NONE. */
+void Rect_free(Rect_T oRect) {
+   Rect_freeRange(oRect, 1);
+}
 
-   upRight = Vector_sum(center, upperHyp);
-   upLeft = Vector_diff(center, lowerHyp);
-   downLeft = Vector_diff(center, upperHyp);
-   downRight = Vector_sum(center, lowerHyp);
+/* Draws oRect onto the screen in color iColor, placed in the world by
+   oPose.  It is a checked runtime error for oRect not to be in the store. */
+void Rect_draw(Rect_T oRect, Pose_T oPose, Color_T iColor) {
+   Vec2_T aoCorners[4];
+   int i;
 
-   Vector_free(center);
-   Vector_free(upperHyp);
-   Vector_free(lowerHyp);
+   Rect_getCorners(oRect, oPose, aoCorners);
 
-   Vector_drawBetween(upRight, upLeft, iColor);
-   Vector_drawBetween(upLeft, downLeft, iColor);
-   Vector_drawBetween(downLeft, downRight, iColor);
-   Vector_drawBetween(downRight, upRight, iColor);
+   for (i = 0; i < 4; i++)
+      Render_line(aoCorners[i].dX, aoCorners[i].dY,
+                  aoCorners[(i + 1) % 4].dX, aoCorners[(i + 1) % 4].dY,
+                  iColor, RENDER_LAYER_SHIPS);
 /*
    This would draw the individaul corners, but it just doesn't
    look right at this moment
 
-   Vector_draw(upRight, iColor);
-   Vector_draw(upLeft, iColor);
-   Vector_draw(downLeft, iColor);
-   Vector_draw(downRight, iColor);
+   Vec2_draw(aoCorners[0], iColor);
+   Vec2_draw(aoCorners[1], iColor);
+   Vec2_draw(aoCorners[2], iColor);
+   Vec2_draw(aoCorners[3], iColor);
 */
-   Vector_free(upRight);
-   Vector_free(upLeft);
-   Vector_free(downLeft);
-   Vector_free(downRight);
 }
 
-/* Rotates oRect's object by angle dTheta.  It is a checked runtime error for
-   oRect to be NULL. */
-void Rect_rotateObj(Rect_T oRect, double dTheta) {
-   assert(oRect != NULL);
-   Vector_rotate(oRect->offset, dTheta);
-   Vector_rotate(oRect->axisX, dTheta);
-   Vector_rotate(oRect->axisY, dTheta);
-}
+/* Fills aoCorners with the world space corners of oRect when placed by
+   oPose, in the order upper right, upper left, lower left, lower right.  It
+   is a checked runtime error for oRect not to be in the store. */
+void Rect_getCorners(Rect_T oRect, Pose_T oPose, Vec2_T aoCorners[4]) {
+   Vec2_T upperHyp, lowerHyp;
+   Vec2_T center, scaledX, scaledY;
+
+   assert(Rect_inStore(oRect, 1));
 
-/* Translates oRect's object by (dX, dY).  It is a checked runtime error for
-   oRectto be NULL. */
-void Rect_translateObj(Rect_T oRect, double dX, double dY) {
-   assert(oRect != NULL);
-   Vector_setX(oRect->objCenter, Vector_getX(oRect->objCenter) + dX);
-   Vector_setY(oRect->objCenter, Vector_getY(oRect->objCenter) + dY);
+   scaledX = Vec2_scale(Pose_rotate(oPose, Rect_getXAxis(oRect)),
+                        oStore.pdExtentX[oRect]);
+   scaledY = Vec2_scale(Pose_rotate(oPose, Rect_getYAxis(oRect)),
+                        oStore.pdExtentY[oRect]);
+
+   center = Pose_transform(oPose, Rect_getOffset(oRect));
+   upperHyp = Vec2_sum(scaledX, scaledY);
+   lowerHyp = Vec2_diff(scaledX, scaledY);
+
+   aoCorners[0] = Vec2_sum(center, upperHyp);
+   aoCorners[1] = Vec2_diff(center, lowerHyp);
+   aoCorners[2] = Vec2_diff(center, upperHyp);
+   aoCorners[3] = Vec2_sum(center, lowerHyp);
 }
 
 /* Rotates oRect alone by angle dTheta.  It is a checked runtime error for
-   oRect to be NULL. */
+   oRect not to be in the store. */
 void Rect_rotateRect(Rect_T oRect, double dTheta) {
-   assert(oRect != NULL);
-   Vector_rotate(oRect->axisX, dTheta);
-   Vector_rotate(oRect->axisY, dTheta);
+   Vec2_T axisX, axisY;
+
+   assert(Rect_inStore(oRect, 1));
+   axisX = Vec2_rotate(Rect_getXAxis(oRect), dTheta);
+   axisY = Vec2_rotate(Rect_getYAxis(oRect), dTheta);
+   oStore.pdAxisXX[oRect] = axisX.dX;
+   oStore.pdAxisXY[oRect] = axisX.dY;
+   oStore.pdAxisYX[oRect] = axisY.dX;
+   oStore.pdAxisYY[oRect] = axisY.dY;
 }
 
 /* Translates oRect alone by (dX, dY).  It is a checked runtime error for
-   oRectto be NULL. */
+   oRect not to be in the store. */
 void Rect_translateRect(Rect_T oRect, double dX, double dY) {
-   assert(oRect != NULL);
-   Vector_setX(oRect->offset, Vector_getX(oRect->offset) + dX);
-   Vector_setY(oRect->offset, Vector_getY(oRect->offset) + dY);
+   assert(Rect_inStore(oRect, 1));
+   oStore.pdOffsetX[oRect] += dX;
+   oStore.pdOffsetY[oRect] += dY;
 }
 
-/* Returns 1 if oRect1 and oRect2 intersect, and zero otherwise.  It is a
-   checked runtime error for oRect1 or orRect2 to be NULL. */
-int Rect_doIntersect(Rect_T oRect1, Rect_T oRect2) {
-   Vector_T T, L;
-   double R1, R2, scale;
-
-   assert((oRect1 != NULL) && (oRect2 != NULL));
-
-   /* T is the distance between centers. */
-   T = Vector_diff(oRect2->objCenter, oRect1->objCenter);
-   Vector_plus(T, oRect2->offset);
-   Vector_minus(T, oRect1->offset);
-
-/* We must scale L by the length of T in order to make sure that the dot
-   product of T and L will be determined by T's length, not L's.  Here L
-   is the separting axis we are currently testing for. */
-   scale = Vector_length(T);
-   L = Vector_copy(oRect1->axisX);
-   Vector_scale(L, scale);
-
-   R1 = oRect1->extentX * abs(Vector_dot(oRect1->axisX, L)) +
-        oRect1->extentY * abs(Vector_dot(oRect1->axisY, L));
-   R2 = oRect2->extentX * abs(Vector_dot(oRect2->axisX, L)) +
-        oRect2->extentY * abs(Vector_dot(oRect2->axisY, L));
-   if (abs(Vector_dot(T, L)) > R1 + R2) {
-      Vector_free(L);
-      Vector_free(T);
-      return 0;
-   }
-   Vector_free(L);
-
-   L = Vector_copy(oRect1->axisY);
-   Vector_scale(L, scale);
-   R1 = oRect1->extentX * abs(Vector_dot(oRect1->axisX, L)) +
-        oRect1->extentY * abs(Vector_dot(oRect1->axisY, L));
-   R2 = oRect2->extentX * abs(Vector_dot(oRect2->axisX, L)) +
-        oRect2->extentY * abs(Vector_dot(oRect2->axisY, L));
-   if (abs(Vector_dot(T, L)) > R1 + R2) {
-      Vector_free(L);
-      Vector_free(T);
-      return 0;
-   }
-   Vector_free(L);
-
-   L = Vector_copy(oRect2->axisX);
-   Vector_scale(L, scale);
-   R1 = oRect1->extentX * abs(Vector_dot(oRect1->axisX, L)) +
-        oRect1->extentY * abs(Vector_dot(oRect1->axisY, L));
-   R2 = oRect2->extentX * abs(Vector_dot(oRect2->axisX, L)) +
-        oRect2->extentY * abs(Vector_dot(oRect2->axisY, L));
-   if (abs(Vector_dot(T, L)) > R1 + R2) {
-      Vector_free(L);
-      Vector_free(T);
-      return 0;
-   }
-   Vector_free(L);
-
-   L = Vector_copy(oRect2->axisY);
-   Vector_scale(L, scale);
-   R1 = oRect1->extentX * abs(Vector_dot(oRect1->axisX, L)) +
-        oRect1->extentY * abs(Vector_dot(oRect1->axisY, L));
-   R2 = oRect2->extentX * abs(Vector_dot(oRect2->axisX, L)) +
-        oRect2->extentY * abs(Vector_dot(oRect2->axisY, L));
-   if (abs(Vector_dot(T, L)) > R1 + R2) {
-      Vector_free(L);
-      Vector_free(T);
-      return 0;
-   }
-   Vector_free(L);
+/* Packs oRect placed by oPose into pdBox for the separating axis test.  It
+   is a checked runtime error for oRect not to be in the store. */
+void Rect_getBox(Rect_T oRect, Pose_T oPose, double pdBox[SAT_BOX_SIZE]) {
+   Vec2_T oCenter, oAxis;
+
+   assert(Rect_inStore(oRect, 1));
+
+   /* A rect's y-axis is always its x-axis turned a quarter turn, so only
+      the x-axis needs packing. */
+   oCenter = Pose_transform(oPose, Rect_getOffset(oRect));
+   oAxis = Pose_rotate(oPose, Rect_getXAxis(oRect));
+   pdBox[SAT_CENTER_X] = oCenter.dX;
+   pdBox[SAT_CENTER_Y] = oCenter.dY;
+   pdBox[SAT_AXIS_X] = oAxis.dX;
+   pdBox[SAT_AXIS_Y] = oAxis.dY;
+   pdBox[SAT_EXTENT_X] = oStore.pdExtentX[oRect];
+   pdBox[SAT_EXTENT_Y] = oStore.pdExtentY[oRect];
+}
+
+/* Returns 1 if oRect1 placed by oPose1 and oRect2 placed by oPose2
+   intersect, and zero otherwise.  It is a checked runtime error for oRect1
+   or oRect2 not to be in the store. */
+int Rect_doIntersect(Rect_T oRect1, Pose_T oPose1, Rect_T oRect2,
+                     Pose_T oPose2) {
+   double adBox1[SAT_BOX_SIZE], adBox2[SAT_BOX_SIZE];
 
-   Vector_free(T);
-   return 1;
+   Rect_getBox(oRect1, oPose1, adBox1);
+   Rect_getBox(oRect2, oPose2, adBox2);
+   return Sat_overlap(adBox1, adBox2);
 }
 
-/* Returns the mass of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns the mass of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getMass(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->mass;
+   assert(Rect_inStore(oRect, 1));
+   return oStore.pdMass[oRect];
 }
 
-/* Returns the xextent of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns the xextent of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getXExt(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->extentX;
+   assert(Rect_inStore(oRect, 1));
+   return oStore.pdExtentX[oRect];
 }
 
-/* Returns the yextent of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns the yextent of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getYExt(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->extentY;
+   assert(Rect_inStore(oRect, 1));
+   return oStore.pdExtentY[oRect];
 }
 
 /* Returns the offset vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getOffset(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->offset;
+   error for oRect not to be in the store. */
+Vec2_T Rect_getOffset(Rect_T oRect) {
+   assert(Rect_inStore(oRect, 1));
+   return Vec2_make(oStore.pdOffsetX[oRect], oStore.pdOffsetY[oRect]);
 }
 
-/* Returns the yaxis vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getYAxis(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->axisY;
+/* Sets the offset vector for oRect to be oOffset.  It is a checked runtime
+   error for oRect not to be in the store. */
+void Rect_setOffset(Rect_T oRect, Vec2_T oOffset) {
+   assert(Rect_inStore(oRect, 1));
+   oStore.pdOffsetX[oRect] = oOffset.dX;
+   oStore.pdOffsetY[oRect] = oOffset.dY;
 }
 
-/* Returns the xaxis vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getXAxis(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->axisX;
+/* Returns the yaxis vector for oRect.  It is a checked runtime
+   error for oRect not to be in the store. */
+Vec2_T Rect_getYAxis(Rect_T oRect) {
+   assert(Rect_inStore(oRect, 1));
+   return Vec2_make(oStore.pdAxisYX[oRect], oStore.pdAxisYY[oRect]);
 }
 
-/* Returns the center vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getCenter(Rect_T oRect) {
-   assert(oRect != NULL);
-   return oRect->objCenter;
+/* Returns the xaxis vector for oRect.  It is a checked runtime
+   error for oRect not to be in the store. */
+Vec2_T Rect_getXAxis(Rect_T oRect) {
+   assert(Rect_inStore(oRect, 1));
+   return Vec2_make(oStore.pdAxisXX[oRect], oStore.pdAxisXY[oRect]);
 }
 
 /* Returns the moment of oRect about its axis.  It is checked runtime error
-   for oRect to be NULL. */
+   for oRect not to be in the store. */
 double Rect_getMoment(Rect_T oRect) {
    double I;
    double x, y;
 
-   assert(oRect != NULL);
+   assert(Rect_inStore(oRect, 1));
 
-   x = oRect->extentX;
-   y = oRect->extentY;
-   I = oRect->mass * (x*x + y*y) / 3.0;
+   x = oStore.pdExtentX[oRect];
+   y = oStore.pdExtentY[oRect];
+   I = oStore.pdMass[oRect] * (x*x + y*y) / 3.0;
 
-   I += oRect->mass * Vector_length(oRect->offset);
+   I += oStore.pdMass[oRect] * Vec2_length(Rect_getOffset(oRect));
 
    return I;
 }
-
-
-
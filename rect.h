@@ -33,71 +33,102 @@
 
 #include "vector.h"
 #include "draw.h"
+#include "sat.h"
 
-typedef struct Rect* Rect_T;
+/* Rects live in a single store made of parallel arrays, one per field, so
+   the rects of a ship sit next to each other in memory and can be swept
+   over linearly.  A Rect_T is the index of a rect in that store.  It stays
+   valid when the store grows. */
+typedef int Rect_T;
+
+/* The Rect_T that refers to no rect at all. */
+#define RECT_NONE (-1)
+
+/* Reserves iCount contiguous rects in the store and returns the first of
+   them.  The rest are oFirst + 1 through oFirst + iCount - 1.  Each rect is
+   set up as by Rect_new(0, 0, 0).  It is a checked runtime error for iCount
+   to be less than one. */
+Rect_T Rect_newRange(int iCount);
+
+/* Releases the iCount rects starting at oFirst back to the store.  Does
+   nothing if oFirst is RECT_NONE.  It is a checked runtime error for the
+   range not to have come from Rect_newRange. */
+void Rect_freeRange(Rect_T oFirst, int iCount);
 
 /* Returns a new Rect_T centered at the origin with x-extent X and y-extent Y.
    The new Rect is axis-aligned to start, and (X, Y) represents the upper
    right corner of this rectangle. */
 Rect_T Rect_new(double X, double Y, double mass);
 
-/* Frees all memory occupied by oRect.  Does nothing if oRect is NULL. */
+/* Resets oRect to be centered at the origin with x-extent X and y-extent Y,
+   as if it had just been returned by Rect_new.  It is a checked runtime
+   error for oRect not to be in the store. */
+void Rect_init(Rect_T oRect, double X, double Y, double mass);
+
+/* Frees the single rect oRect.  Does nothing if oRect is RECT_NONE. */
 void Rect_free(Rect_T oRect);
 
-/* Draws oRect onto the screen in color iColor.  It is a checked runtime
-   error for oRect to be NULL. */
-void Rect_draw(Rect_T oRect, Color_T iColor);
+/* Draws oRect onto the screen in color iColor, placed in the world by
+   oPose.  It is a checked runtime error for oRect not to be in the store. */
+void Rect_draw(Rect_T oRect, Pose_T oPose, Color_T iColor);
 
-/* Rotates oRect's object by angle dTheta.  It is a checked runtime error for
-   oRect to be NULL. */
-void Rect_rotateObj(Rect_T oRect, double dTheta);
+/* Fills aoCorners with the world space corners of oRect when placed by
+   oPose, in the order upper right, upper left, lower left, lower right.  It
+   is a checked runtime error for oRect not to be in the store. */
+void Rect_getCorners(Rect_T oRect, Pose_T oPose, Vec2_T aoCorners[4]);
 
-/* Translates oRect's object by (dX, dY).  It is a checked runtime error for
-   oRectto be NULL. */
-void Rect_translateObj(Rect_T oRect, double dX, double dY);
+/* The offset and axes of a rect are in the body space of the object it
+   belongs to, and are not touched as that object moves.  The functions
+   below are for laying out the object in the first place. */
 
 /* Rotates oRect alone by angle dTheta.  It is a checked runtime error for
-   oRect to be NULL. */
+   oRect not to be in the store. */
 void Rect_rotateRect(Rect_T oRect, double dTheta);
 
 /* Translates oRect alone by (dX, dY).  It is a checked runtime error for
-   oRectto be NULL. */
+   oRect not to be in the store. */
 void Rect_translateRect(Rect_T oRect, double dX, double dY);
 
-/* Returns 1 if oRect1 and oRect2 intersect, and zero otherwise.  It is a
-   checked runtime error for oRect1 or orRect2 to be NULL. */
-int Rect_doIntersect(Rect_T oRect1, Rect_T oRect2);
+/* Packs oRect placed by oPose into pdBox for the separating axis test.  It
+   is a checked runtime error for oRect not to be in the store. */
+void Rect_getBox(Rect_T oRect, Pose_T oPose, double pdBox[SAT_BOX_SIZE]);
 
-/* Returns the mass of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns 1 if oRect1 placed by oPose1 and oRect2 placed by oPose2
+   intersect, and zero otherwise.  It is a checked runtime error for oRect1
+   or oRect2 not to be in the store. */
+int Rect_doIntersect(Rect_T oRect1, Pose_T oPose1, Rect_T oRect2,
+                     Pose_T oPose2);
+
+/* Returns the mass of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getMass(Rect_T oRect);
 
-/* Returns the xextent of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns the xextent of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getXExt(Rect_T oRect);
 
-/* Returns the yextent of oRect.  It is a checked runtime error for oRect to
-   be NULL. */
+/* Returns the yextent of oRect.  It is a checked runtime error for oRect not
+   to be in the store. */
 double Rect_getYExt(Rect_T oRect);
 
 /* Returns the offset vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getOffset(Rect_T oRect);
+   error for oRect not to be in the store. */
+Vec2_T Rect_getOffset(Rect_T oRect);
+
+/* Sets the offset vector for oRect to be oOffset.  It is a checked runtime
+   error for oRect not to be in the store. */
+void Rect_setOffset(Rect_T oRect, Vec2_T oOffset);
 
 /* Returns the yaxis vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getYAxis(Rect_T oRect);
+   error for oRect not to be in the store. */
+Vec2_T Rect_getYAxis(Rect_T oRect);
 
 /* Returns the xaxis vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getXAxis(Rect_T oRect);
-
-/* Returns the center vector for oRect.  It is a checked runtime
-   error for oRect to be NULL. */
-Vector_T Rect_getCenter(Rect_T oRect);
+   error for oRect not to be in the store. */
+Vec2_T Rect_getXAxis(Rect_T oRect);
 
 /* Returns the moment of oRect about its axis.  It is checked runtime error
-   for oRect to be NULL. */
+   for oRect not to be in the store. */
 double Rect_getMoment(Rect_T oRect);
 
 #endif
@@ -0,0 +1,686 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: render.c defines the implementation for the frame's command
+ *    buffer.  The buffers grow to fit the busiest frame seen and are reused
+ *    from then on, so recording does not allocate in the steady state.
+ *    Flushing bins the frame into tiles of the screen and draws the tiles
+ *    on a pool of threads.  Each tile is drawn by one thread, in the same
+ *    order the whole screen would be, so the result does not depend on how
+ *    many threads there are.  There are two frames: while one is recorded,
+ *    the other can be drawn by a render thread of its own.
+ ___________________________________________________________________________*/
+
+#include "render.h"
+#include "draw.h"
+#include "pool.h"
+#include <SDL.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define INITIAL_COMMANDS 256
+#define INITIAL_POINTS 4096
+#define TILE_SIZE 64          /* Pixels on a side of a tile. */
+#define PROJECT_CHUNK 16384   /* Points projected by each job. */
+
+/* Kinds of command. */
+#define COMMAND_LINE 0
+#define COMMAND_POINTS 1
+
+/* One recorded command.  A line uses the coordinates as its endpoints; a
+   run of points uses them as its bounding box, and its points are
+   iCount floats from iFirst in the point buffers. */
+struct Command {
+       int iKind;
+       int iLayer;
+       Color_T iColor;
+       double dX1;
+       double dY1;
+       double dX2;
+       double dY2;
+       int iFirst;
+       int iCount;
+       };
+
+/* A recorded frame: its commands, the points they draw, and the view
+   they were recorded under. */
+struct Frame {
+       struct Command* poCommands;
+       int iNumCommands;
+       int iCommandCapacity;
+       float* pfPointX;
+       float* pfPointY;
+       int iNumPoints;
+       int iPointCapacity;
+       DrawView_T oView;
+       };
+
+/* The frame being recorded, and the other one, which the render thread
+   may be drawing. */
+static struct Frame aoFrames[2];
+static struct Frame* poRecording = &aoFrames[0];
+static struct Frame* poSpare = &aoFrames[1];
+
+/* Commands in the order they are drawn, rebuilt by each flush. */
+static int* piOrder;
+static int iOrderCapacity;
+
+/* Where each point lands on the screen, the tile it is in or -1, and its
+   command, rebuilt by each flush. */
+static int* piPixelX;
+static int* piPixelY;
+static int* piPointTile;
+static int* piPointCommand;
+static int iPixelCapacity;
+
+/* How many points of each chunk land in each tile: chunk c's counts are
+   from piChunkCounts[c * iTilesX * iTilesY]. */
+static int* piChunkCounts;
+static int iChunkCountCapacity;
+
+/* What each tile draws, in order: a point's index, or -1 - i for line i.
+   Tile t's entries are from piTileStart[t] up to piTileStart[t + 1]. */
+static int* piTileEntries;
+static int iEntryCapacity;
+static int* piTileStart;
+static int iTilesX;
+static int iTilesY;
+
+/* The threads that draw the tiles. */
+static Pool_T oPool;
+
+/* The render thread and how frames are handed to it.  poSubmitted is the
+   frame it has been given and not yet finished, or NULL; both threads
+   change it only while holding oLock, signalling oWake when a frame is
+   given or isQuit set, and oDone when a frame is finished. */
+static SDL_Thread* oThread;
+static SDL_mutex* oLock;
+static SDL_cond* oWake;
+static SDL_cond* oDone;
+static struct Frame* poSubmitted;
+static int isQuit;
+
+/* In house function for returning a new command of kind iKind on layer
+   iLayer with color color, growing the buffer if need be. */
+static struct Command* Render_newCommand(int iKind, int iLayer,
+                                         Color_T color) {
+   struct Command* poCommand;
+
+   struct Frame* poFrame = poRecording;
+
+   assert(iLayer >= 0 && iLayer < RENDER_NUM_LAYERS);
+   if (poFrame->iNumCommands == poFrame->iCommandCapacity) {
+      poFrame->iCommandCapacity = poFrame->iCommandCapacity
+                                  ? 2 * poFrame->iCommandCapacity
+                                  : INITIAL_COMMANDS;
+      poFrame->poCommands = (struct Command*)realloc(poFrame->poCommands,
+                               poFrame->iCommandCapacity *
+                               sizeof(struct Command));
+      assert(poFrame->poCommands != NULL);
+   }
+   poCommand = &poFrame->poCommands[poFrame->iNumCommands++];
+   poCommand->iKind = iKind;
+   poCommand->iLayer = iLayer;
+   poCommand->iColor = color;
+   return poCommand;
+}
+
+/* In house function for making room for iCount more points. */
+static void Render_reservePoints(int iCount) {
+   struct Frame* poFrame = poRecording;
+
+   if (poFrame->iNumPoints + iCount <= poFrame->iPointCapacity)
+      return;
+   if (poFrame->iPointCapacity == 0)
+      poFrame->iPointCapacity = INITIAL_POINTS;
+   while (poFrame->iNumPoints + iCount > poFrame->iPointCapacity)
+      poFrame->iPointCapacity *= 2;
+   poFrame->pfPointX = (float*)realloc(poFrame->pfPointX,
+                                      poFrame->iPointCapacity *
+                                      sizeof(float));
+   poFrame->pfPointY = (float*)realloc(poFrame->pfPointY,
+                                      poFrame->iPointCapacity *
+                                      sizeof(float));
+   assert(poFrame->pfPointX != NULL && poFrame->pfPointY != NULL);
+}
+
+/* Records a line from (dX1, dY1) to (dX2, dY2) in world space, with color
+   color, on layer iLayer.  It is a checked runtime error for iLayer not to
+   be a layer. */
+void Render_line(double dX1, double dY1, double dX2, double dY2,
+                 Color_T color, int iLayer) {
+   struct Command* poCommand = Render_newCommand(COMMAND_LINE, iLayer, color);
+   poCommand->dX1 = dX1;
+   poCommand->dY1 = dY1;
+   poCommand->dX2 = dX2;
+   poCommand->dY2 = dY2;
+}
+
+/* Records a point at (dX, dY) in world space, with color color, on layer
+   iLayer.  It is a checked runtime error for iLayer not to be a layer. */
+void Render_point(double dX, double dY, Color_T color, int iLayer) {
+   float fX = (float)dX, fY = (float)dY;
+   Render_points(&fX, &fY, 1, color, iLayer);
+}
+
+/* Records iCount points at (pfX[i], pfY[i]) in world space, with color
+   color, on layer iLayer.  The points are copied, so the arrays may change
+   before the frame is drawn.  It is a checked runtime error for pfX or pfY
+   to be NULL or for iLayer not to be a layer. */
+void Render_points(const float* pfX, const float* pfY, int iCount,
+                   Color_T color, int iLayer) {
+   struct Command* poCommand;
+   float *pfToX, *pfToY;
+   float fMinX, fMinY, fMaxX, fMaxY;
+   int i;
+
+   assert(pfX != NULL && pfY != NULL);
+   if (iCount <= 0)
+      return;
+
+   Render_reservePoints(iCount);
+   poCommand = Render_newCommand(COMMAND_POINTS, iLayer, color);
+   poCommand->iFirst = poRecording->iNumPoints;
+   poCommand->iCount = iCount;
+
+   /* Copy the points, finding their bounding box on the way. */
+   pfToX = poRecording->pfPointX + poRecording->iNumPoints;
+   pfToY = poRecording->pfPointY + poRecording->iNumPoints;
+   fMinX = fMaxX = pfX[0];
+   fMinY = fMaxY = pfY[0];
+   for (i = 0; i < iCount; i++) {
+      pfToX[i] = pfX[i];
+      pfToY[i] = pfY[i];
+      if (pfX[i] < fMinX) fMinX = pfX[i];
+      if (pfX[i] > fMaxX) fMaxX = pfX[i];
+      if (pfY[i] < fMinY) fMinY = pfY[i];
+      if (pfY[i] > fMaxY) fMaxY = pfY[i];
+   }
+   poRecording->iNumPoints += iCount;
+
+   poCommand->dX1 = fMinX;
+   poCommand->dY1 = fMinY;
+   poCommand->dX2 = fMaxX;
+   poCommand->dY2 = fMaxY;
+}
+
+/* Draws with iNumThreads threads from now on, counting the one that calls
+   Render_flush.  It is a checked runtime error for iNumThreads not to be
+   positive. */
+void Render_setThreads(int iNumThreads) {
+   assert(iNumThreads > 0);
+   Render_finish();
+   Pool_free(oPool);
+   oPool = Pool_new(iNumThreads - 1);
+}
+
+/* In house function for projecting the points in chunk iChunk of the
+   frame pvExtra, and counting how many land in each tile. */
+static void Render_projectChunk(int iChunk, int iThread, void* pvExtra) {
+   struct Frame* poFrame = (struct Frame*)pvExtra;
+   int iFirst = iChunk * PROJECT_CHUNK;
+   int iCount = poFrame->iNumPoints - iFirst < PROJECT_CHUNK
+                ? poFrame->iNumPoints - iFirst : PROJECT_CHUNK;
+   int* piCounts = piChunkCounts + iChunk * iTilesX * iTilesY;
+   int iWidth = Draw_getWidth(), iHeight = Draw_getHeight();
+   int i, x, y;
+
+   Draw_projectPoints(&poFrame->oView, poFrame->pfPointX + iFirst,
+                      poFrame->pfPointY + iFirst, iCount, piPixelX + iFirst,
+                      piPixelY + iFirst);
+
+   for (i = 0; i < iTilesX * iTilesY; i++)
+      piCounts[i] = 0;
+   for (i = iFirst; i < iFirst + iCount; i++) {
+      x = piPixelX[i];
+      y = piPixelY[i];
+      if (x < 0 || x >= iWidth || y < 0 || y >= iHeight)
+         piPointTile[i] = -1;
+      else {
+         piPointTile[i] = (y / TILE_SIZE) * iTilesX + x / TILE_SIZE;
+         piCounts[piPointTile[i]]++;
+      }
+   }
+}
+
+/* In house function for drawing everything of the frame pvExtra binned
+   into tile iTile. */
+static void Render_drawTile(int iTile, int iThread, void* pvExtra) {
+   struct Frame* poFrame = (struct Frame*)pvExtra;
+   DrawClip_T oClip;
+   struct Command* poCommand;
+   int i, iEntry;
+
+   oClip.iLeft = (iTile % iTilesX) * TILE_SIZE;
+   oClip.iTop = (iTile / iTilesX) * TILE_SIZE;
+   oClip.iRight = oClip.iLeft + TILE_SIZE;
+   oClip.iBottom = oClip.iTop + TILE_SIZE;
+   if (oClip.iRight > Draw_getWidth())
+      oClip.iRight = Draw_getWidth();
+   if (oClip.iBottom > Draw_getHeight())
+      oClip.iBottom = Draw_getHeight();
+
+   for (i = piTileStart[iTile]; i < piTileStart[iTile + 1]; i++) {
+      iEntry = piTileEntries[i];
+      if (iEntry < 0) {
+         poCommand = &poFrame->poCommands[-1 - iEntry];
+         Draw_drawScaledLineClipped(&poFrame->oView, poCommand->dX1,
+                                    poCommand->dY1, poCommand->dX2,
+                                    poCommand->dY2, poCommand->iColor,
+                                    &oClip);
+      }
+      else
+         Draw_drawPixel(piPixelX[iEntry], piPixelY[iEntry],
+                        poFrame->poCommands[piPointCommand[iEntry]].iColor);
+   }
+}
+
+/* In house function for binning line iLine, the command poCommand, into
+   the tiles it crosses under poView: counting it in each tile's start on
+   pass 0 and adding it to each tile's entries on pass 1.  Each run of the
+   line across a column (or row) of tiles is binned into the tiles that
+   the pixels either side of it might reach, with a pixel to spare for
+   Draw_lineClipped's fixed point. */
+static void Render_binLine(const DrawView_T* poView,
+                           struct Command* poCommand, int iLine, int iPass) {
+   int x1, y1, x2, y2, a1, b1, a2, b2, iALimit, iBLimit, iA, iALast;
+   int iBFirst, iBLast, iB, iTile;
+   int isXMajor;
+   double dDb, dFrom, dTo, dLo, dHi, dSwap;
+
+   Draw_projectPoint(poView, poCommand->dX1, poCommand->dY1, &x1, &y1);
+   Draw_projectPoint(poView, poCommand->dX2, poCommand->dY2, &x2, &y2);
+
+   /* A horizontal line covers its row and the rows either side. */
+   if (y1 == y2) {
+      isXMajor = 1;
+      a1 = x1 < x2 ? x1 : x2;
+      a2 = x1 < x2 ? x2 : x1;
+      b1 = y1;
+      dDb = 0;
+   }
+   else {
+      isXMajor = abs(x2 - x1) >= abs(y2 - y1);
+      a1 = isXMajor ? x1 : y1;
+      b1 = isXMajor ? y1 : x1;
+      a2 = isXMajor ? x2 : y2;
+      b2 = isXMajor ? y2 : x2;
+      if (a1 > a2) {
+         iA = a1; a1 = a2; a2 = iA;
+         iB = b1; b1 = b2; b2 = iB;
+      }
+      dDb = ((double)b2 - b1) / ((double)a2 - a1);
+   }
+   iALimit = isXMajor ? Draw_getWidth() : Draw_getHeight();
+   iBLimit = isXMajor ? Draw_getHeight() : Draw_getWidth();
+   if (a2 < 0 || a1 >= iALimit)
+      return;
+
+   for (iA = (a1 > 0 ? a1 : 0) / TILE_SIZE,
+        iALast = (a2 < iALimit - 1 ? a2 : iALimit - 1) / TILE_SIZE;
+        iA <= iALast; iA++) {
+      /* Where the line is across this run of tiles. */
+      dFrom = iA * TILE_SIZE > a1 ? iA * TILE_SIZE : a1;
+      dTo = iA * TILE_SIZE + TILE_SIZE - 1 < a2
+            ? iA * TILE_SIZE + TILE_SIZE - 1 : a2;
+      dLo = b1 + (dFrom - a1) * dDb;
+      dHi = b1 + (dTo - a1) * dDb;
+      if (dLo > dHi) {
+         dSwap = dLo; dLo = dHi; dHi = dSwap;
+      }
+      dLo = floor(dLo + 0.5) - 2;
+      dHi = floor(dHi + 0.5) + 2;
+      if (dHi < 0 || dLo >= iBLimit)
+         continue;
+      iBFirst = dLo < 0 ? 0 : (int)dLo / TILE_SIZE;
+      iBLast = dHi >= iBLimit ? (iBLimit - 1) / TILE_SIZE
+                              : (int)dHi / TILE_SIZE;
+
+      for (iB = iBFirst; iB <= iBLast; iB++) {
+         iTile = isXMajor ? iB * iTilesX + iA : iA * iTilesX + iB;
+         if (iPass == 0)
+            piTileStart[iTile + 1]++;
+         else
+            piTileEntries[piTileStart[iTile]++] = -1 - iLine;
+      }
+   }
+}
+
+/* In house function for binning poFrame's commands into tiles, in the
+   order they are to be drawn.  The points have been counted already, a
+   chunk at a time; the lines are counted here, and then everything is
+   filled in. */
+static void Render_bin(struct Frame* poFrame) {
+   const DrawView_T* poView = &poFrame->oView;
+   struct Command* poCommand;
+   int iNumTiles = iTilesX * iTilesY;
+   int iNumChunks = (poFrame->iNumPoints + PROJECT_CHUNK - 1) /
+                    PROJECT_CHUNK;
+   int iPass, iTile, i, j, iCommand;
+
+   for (iTile = 0; iTile < iNumTiles; iTile++)
+      for (i = 0; i < iNumChunks; i++)
+         piTileStart[iTile + 1] += piChunkCounts[i * iNumTiles + iTile];
+
+   for (iPass = 0; iPass < 2; iPass++) {
+      for (i = 0; i < poFrame->iNumCommands; i++) {
+         iCommand = piOrder[i];
+         poCommand = &poFrame->poCommands[iCommand];
+
+         if (poCommand->iKind == COMMAND_LINE) {
+            if (Draw_isVisibleIn(poView, poCommand->dX1 < poCommand->dX2
+                                 ? poCommand->dX1 : poCommand->dX2,
+                                 poCommand->dY1 < poCommand->dY2
+                                 ? poCommand->dY1 : poCommand->dY2,
+                                 poCommand->dX1 > poCommand->dX2
+                                 ? poCommand->dX1 : poCommand->dX2,
+                                 poCommand->dY1 > poCommand->dY2
+                                 ? poCommand->dY1 : poCommand->dY2))
+               Render_binLine(poView, poCommand, iCommand, iPass);
+         }
+
+         /* Every point on the screen has been counted, so every one must
+            be filled in. */
+         else if (iPass == 1)
+            for (j = poCommand->iFirst;
+                 j < poCommand->iFirst + poCommand->iCount; j++)
+               if (piPointTile[j] >= 0) {
+                  piPointCommand[j] = iCommand;
+                  piTileEntries[piTileStart[piPointTile[j]]++] = j;
+               }
+      }
+
+      if (iPass == 0) {
+         /* Turn the counts into where each tile starts. */
+         for (iTile = 0; iTile < iNumTiles; iTile++)
+            piTileStart[iTile + 1] += piTileStart[iTile];
+         if (iEntryCapacity < piTileStart[iNumTiles]) {
+            iEntryCapacity = piTileStart[iNumTiles];
+            piTileEntries = (int*)realloc(piTileEntries,
+                                          iEntryCapacity * sizeof(int));
+            assert(piTileEntries != NULL);
+         }
+      }
+   }
+
+   /* Filling moved each start along to the next tile's; move them back. */
+   for (iTile = iNumTiles; iTile > 0; iTile--)
+      piTileStart[iTile] = piTileStart[iTile - 1];
+   piTileStart[0] = 0;
+}
+
+/* In house function for binning the frame pvExtra, as the one job of its
+   phase, and marking the tiles with anything in them as drawn on. */
+static void Render_binJob(int iJob, int iThread, void* pvExtra) {
+   int i;
+
+   Render_bin((struct Frame*)pvExtra);
+   for (i = 0; i < iTilesX * iTilesY; i++)
+      if (piTileStart[i + 1] > piTileStart[i])
+         Draw_markDirty((i % iTilesX) * TILE_SIZE, (i / iTilesX) * TILE_SIZE,
+                        TILE_SIZE, TILE_SIZE);
+}
+
+/* In house function for drawing poFrame's commands straight onto the
+   screen, in the order they are to be drawn, for when only one thread
+   draws and binning would gain nothing. */
+static void Render_drawDirect(struct Frame* poFrame) {
+   const DrawView_T* poView = &poFrame->oView;
+   struct Command* poCommand;
+   int i;
+
+   for (i = 0; i < poFrame->iNumCommands; i++) {
+      poCommand = &poFrame->poCommands[piOrder[i]];
+      if (poCommand->iKind == COMMAND_LINE) {
+         if (Draw_isVisibleIn(poView, poCommand->dX1 < poCommand->dX2
+                              ? poCommand->dX1 : poCommand->dX2,
+                              poCommand->dY1 < poCommand->dY2
+                              ? poCommand->dY1 : poCommand->dY2,
+                              poCommand->dX1 > poCommand->dX2
+                              ? poCommand->dX1 : poCommand->dX2,
+                              poCommand->dY1 > poCommand->dY2
+                              ? poCommand->dY1 : poCommand->dY2))
+            Draw_drawScaledLineIn(poView, poCommand->dX1, poCommand->dY1,
+                                  poCommand->dX2, poCommand->dY2,
+                                  poCommand->iColor);
+      }
+      else if (Draw_isVisibleIn(poView, poCommand->dX1, poCommand->dY1,
+                                poCommand->dX2, poCommand->dY2))
+         Draw_drawScaledPixelsIn(poView,
+                                 poFrame->pfPointX + poCommand->iFirst,
+                                 poFrame->pfPointY + poCommand->iFirst,
+                                 poCommand->iCount, poCommand->iColor);
+   }
+}
+
+/* In house function for drawing poFrame with the drawing module, layer by
+   layer, skipping whatever is off the screen, then emptying it. */
+static void Render_drawFrame(struct Frame* poFrame) {
+   int aiStart[RENDER_NUM_LAYERS + 1];
+   int iNumChunks = (poFrame->iNumPoints + PROJECT_CHUNK - 1) /
+                    PROJECT_CHUNK;
+   int iProject, iBin, i;
+
+   /* A counting sort by layer, which keeps the recorded order within each
+      layer. */
+   if (iOrderCapacity < poFrame->iNumCommands) {
+      iOrderCapacity = poFrame->iCommandCapacity;
+      piOrder = (int*)realloc(piOrder, iOrderCapacity * sizeof(int));
+      assert(piOrder != NULL);
+   }
+   for (i = 0; i <= RENDER_NUM_LAYERS; i++)
+      aiStart[i] = 0;
+   for (i = 0; i < poFrame->iNumCommands; i++)
+      aiStart[poFrame->poCommands[i].iLayer + 1]++;
+   for (i = 1; i <= RENDER_NUM_LAYERS; i++)
+      aiStart[i] += aiStart[i - 1];
+   for (i = 0; i < poFrame->iNumCommands; i++)
+      piOrder[aiStart[poFrame->poCommands[i].iLayer]++] = i;
+
+   if (oPool == NULL)
+      oPool = Pool_new(0);
+   if (Pool_getNumThreads(oPool) == 1) {
+      Render_drawDirect(poFrame);
+      poFrame->iNumCommands = 0;
+      poFrame->iNumPoints = 0;
+      return;
+   }
+
+   /* Make room to bin the frame. */
+   if (piTileStart == NULL) {
+      iTilesX = (Draw_getWidth() + TILE_SIZE - 1) / TILE_SIZE;
+      iTilesY = (Draw_getHeight() + TILE_SIZE - 1) / TILE_SIZE;
+      piTileStart = (int*)malloc((iTilesX * iTilesY + 1) * sizeof(int));
+      assert(piTileStart != NULL);
+   }
+   for (i = 0; i <= iTilesX * iTilesY; i++)
+      piTileStart[i] = 0;
+   if (iPixelCapacity < poFrame->iNumPoints) {
+      iPixelCapacity = poFrame->iPointCapacity;
+      piPixelX = (int*)realloc(piPixelX, iPixelCapacity * sizeof(int));
+      piPixelY = (int*)realloc(piPixelY, iPixelCapacity * sizeof(int));
+      piPointTile = (int*)realloc(piPointTile, iPixelCapacity * sizeof(int));
+      piPointCommand = (int*)realloc(piPointCommand,
+                                     iPixelCapacity * sizeof(int));
+      assert(piPixelX != NULL && piPixelY != NULL && piPointTile != NULL &&
+             piPointCommand != NULL);
+   }
+   if (iChunkCountCapacity < iNumChunks * iTilesX * iTilesY) {
+      iChunkCountCapacity = iNumChunks * iTilesX * iTilesY;
+      piChunkCounts = (int*)realloc(piChunkCounts,
+                                    iChunkCountCapacity * sizeof(int));
+      assert(piChunkCounts != NULL);
+   }
+
+   /* Binning needs every point projected, and the tiles need binning. */
+   iProject = Pool_addPhase(oPool, Render_projectChunk, iNumChunks,
+                            poFrame);
+   iBin = Pool_addPhase(oPool, Render_binJob, 1, poFrame);
+   Pool_after(oPool, iBin, iProject);
+   Pool_after(oPool, Pool_addPhase(oPool, Render_drawTile, iTilesX * iTilesY,
+                                   poFrame), iBin);
+   Pool_runGraph(oPool);
+
+   poFrame->iNumCommands = 0;
+   poFrame->iNumPoints = 0;
+}
+
+/* Draws everything recorded since the last flush with the drawing module,
+   layer by layer, skipping whatever is off the screen, then empties the
+   command buffer for the next frame.  The screen should be locked. */
+void Render_flush() {
+   Render_finish();
+   if (Draw_isHeadless()) {
+      poRecording->iNumCommands = 0;
+      poRecording->iNumPoints = 0;
+      return;
+   }
+   Draw_getView(&poRecording->oView);
+   Render_drawFrame(poRecording);
+}
+
+/* In house function run by the render thread: draws each frame it is
+   given on a freshly cleared screen, until Render_quit is called. */
+static int Render_thread(void* pvExtra) {
+   struct Frame* poFrame;
+
+   for (;;) {
+      SDL_LockMutex(oLock);
+      while (poSubmitted == NULL && !isQuit)
+         SDL_CondWait(oWake, oLock);
+      poFrame = poSubmitted;
+      SDL_UnlockMutex(oLock);
+      if (poFrame == NULL)
+         break;
+
+      Draw_lockScreen();
+      Draw_clearScreen();
+      Render_drawFrame(poFrame);
+      Draw_unlockScreen();
+
+      SDL_LockMutex(oLock);
+      poSubmitted = NULL;
+      SDL_CondSignal(oDone);
+      SDL_UnlockMutex(oLock);
+   }
+   return 0;
+}
+
+/* Hands everything recorded since the last flush or submit to the render
+   thread, which clears the screen and draws it there while the next frame
+   is recorded.  The frame keeps the current scale and shift, so they may
+   change straight away.  Waits first for the frame submitted before, if
+   any, to be drawn; call Render_finish and flip the screen before this to
+   show it.  The render thread locks the screen itself. */
+void Render_submit() {
+   struct Frame* poFrame;
+
+   Render_finish();
+   if (Draw_isHeadless()) {
+      poRecording->iNumCommands = 0;
+      poRecording->iNumPoints = 0;
+      return;
+   }
+
+   if (oThread == NULL) {
+      oLock = SDL_CreateMutex();
+      oWake = SDL_CreateCond();
+      oDone = SDL_CreateCond();
+      assert(oLock != NULL && oWake != NULL && oDone != NULL);
+      oThread = SDL_CreateThread(Render_thread, NULL);
+      assert(oThread != NULL);
+   }
+
+   Draw_getView(&poRecording->oView);
+   poFrame = poRecording;
+   poRecording = poSpare;
+   poSpare = poFrame;
+
+   SDL_LockMutex(oLock);
+   poSubmitted = poFrame;
+   SDL_CondSignal(oWake);
+   SDL_UnlockMutex(oLock);
+}
+
+/* Waits until the render thread has drawn the last frame submitted, so
+   that it can be flipped onto the screen or read back.  Returns at once if
+   there is none. */
+void Render_finish() {
+   if (oThread == NULL)
+      return;
+   SDL_LockMutex(oLock);
+   while (poSubmitted != NULL)
+      SDL_CondWait(oDone, oLock);
+   SDL_UnlockMutex(oLock);
+}
+
+/* Waits for the last frame submitted to be drawn, stops the render thread
+   and the threads that draw the tiles, and frees all memory the module
+   occupies.  Whatever was recorded since the last flush or submit is
+   dropped.  The module may be used again afterwards. */
+void Render_quit() {
+   int i;
+
+   Render_finish();
+   if (oThread != NULL) {
+      SDL_LockMutex(oLock);
+      isQuit = 1;
+      SDL_CondSignal(oWake);
+      SDL_UnlockMutex(oLock);
+      SDL_WaitThread(oThread, NULL);
+      SDL_DestroyCond(oDone);
+      SDL_DestroyCond(oWake);
+      SDL_DestroyMutex(oLock);
+      oThread = NULL;
+      isQuit = 0;
+   }
+
+   Pool_free(oPool);
+   oPool = NULL;
+   for (i = 0; i < 2; i++) {
+      free(aoFrames[i].poCommands);
+      free(aoFrames[i].pfPointX);
+      free(aoFrames[i].pfPointY);
+      aoFrames[i].poCommands = NULL;
+      aoFrames[i].pfPointX = aoFrames[i].pfPointY = NULL;
+      aoFrames[i].iNumCommands = aoFrames[i].iCommandCapacity = 0;
+      aoFrames[i].iNumPoints = aoFrames[i].iPointCapacity = 0;
+   }
+
+   free(piOrder);
+   free(piPixelX);
+   free(piPixelY);
+   free(piPointTile);
+   free(piPointCommand);
+   free(piChunkCounts);
+   free(piTileEntries);
+   free(piTileStart);
+   piOrder = piPixelX = piPixelY = piPointTile = piPointCommand = NULL;
+   piChunkCounts = piTileEntries = piTileStart = NULL;
+   iOrderCapacity = iPixelCapacity = iChunkCountCapacity = 0;
+   iEntryCapacity = 0;
+}
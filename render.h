@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: render.h defines the interface for the frame's command
+ *    buffer.  Drawing code records what it wants drawn as it goes; nothing
+ *    touches a pixel until Render_flush draws the whole frame at once.
+ ___________________________________________________________________________*/
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "draw.h"
+
+/* Layers, drawn from first to last.  Within a layer, commands are drawn in
+   the order they were recorded. */
+#define RENDER_LAYER_EFFECTS 0 /* Smoke and flames, under the ships. */
+#define RENDER_LAYER_SHIPS   1
+#define RENDER_LAYER_OVERLAY 2 /* Debugging marks, over everything. */
+#define RENDER_NUM_LAYERS    3
+
+/* Records a line from (dX1, dY1) to (dX2, dY2) in world space, with color
+   color, on layer iLayer.  It is a checked runtime error for iLayer not to
+   be a layer. */
+void Render_line(double dX1, double dY1, double dX2, double dY2,
+                 Color_T color, int iLayer);
+
+/* Records a point at (dX, dY) in world space, with color color, on layer
+   iLayer.  It is a checked runtime error for iLayer not to be a layer. */
+void Render_point(double dX, double dY, Color_T color, int iLayer);
+
+/* Records iCount points at (pfX[i], pfY[i]) in world space, with color
+   color, on layer iLayer.  The points are copied, so the arrays may change
+   before the frame is drawn.  It is a checked runtime error for pfX or pfY
+   to be NULL or for iLayer not to be a layer. */
+void Render_points(const float* pfX, const float* pfY, int iCount,
+                   Color_T color, int iLayer);
+
+/* Draws with iNumThreads threads from now on, counting the one that calls
+   Render_flush.  It is a checked runtime error for iNumThreads not to be
+   positive. */
+void Render_setThreads(int iNumThreads);
+
+/* Draws everything recorded since the last flush with the drawing module,
+   layer by layer, skipping whatever is off the screen, then empties the
+   command buffer for the next frame.  The screen should be locked. */
+void Render_flush();
+
+/* Hands everything recorded since the last flush or submit to the render
+   thread, which clears the screen and draws it there while the next frame
+   is recorded.  The frame keeps the current scale and shift, so they may
+   change straight away.  Waits first for the frame submitted before, if
+   any, to be drawn; call Render_finish and flip the screen before this to
+   show it.  The render thread locks the screen itself. */
+void Render_submit();
+
+/* Waits until the render thread has drawn the last frame submitted, so
+   that it can be flipped onto the screen or read back.  Returns at once if
+   there is none. */
+void Render_finish();
+
+/* Waits for the last frame submitted to be drawn, stops the render thread
+   and the threads that draw the tiles, and frees all memory the module
+   occupies.  Whatever was recorded since the last flush or submit is
+   dropped.  The module may be used again afterwards. */
+void Render_quit();
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: rng.c defines the implementation for the batched parts of
+ *    the random number generator.
+ ___________________________________________________________________________*/
+
+#include "rng.h"
+#include <stdlib.h>
+#include <assert.h>
+
+/* Fills pdOut with iCount random doubles from poRng in [0, 1).  It is a
+   checked runtime error for poRng or pdOut to be NULL. */
+void Rng_fillUniform(Rng_T* poRng, double* pdOut, int iCount) {
+   unsigned long x;
+   int i;
+
+   assert(poRng != NULL && pdOut != NULL);
+
+   /* Keep the state in a local so it can live in a register. */
+   x = poRng->ulState;
+   for (i = 0; i < iCount; i++) {
+      x ^= (x << 13) & RNG_MASK;
+      x ^= x >> 17;
+      x ^= (x << 5) & RNG_MASK;
+      pdOut[i] = x * (1.0 / 4294967296.0);
+   }
+   poRng->ulState = x;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: rng.h defines a small, fast pseudo random number generator.
+ *    Each user owns its own Rng_T, so there is no hidden shared state and a
+ *    run can be repeated exactly from its seed.
+ ___________________________________________________________________________*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <assert.h>
+
+/* The state of one generator.  It is a plain value, so embed it in whatever
+   owns it.  Only the low 32 bits are used, which an unsigned long always
+   has room for. */
+typedef struct Rng {
+       unsigned long ulState;
+       } Rng_T;
+
+#define RNG_MASK 0xFFFFFFFFUL
+
+/* Small enough to be inlined into the callers; see VECTOR_INLINE. */
+#ifdef __GNUC__
+#define RNG_INLINE static __inline__
+#else
+#define RNG_INLINE static
+#endif
+
+/* Returns ulValue scrambled so that nearby values give unrelated results.
+   Use it to derive seeds from other seeds. */
+RNG_INLINE unsigned long Rng_hash(unsigned long ulValue) {
+   ulValue &= RNG_MASK;
+   ulValue = ((ulValue >> 16) ^ ulValue) * 0x45D9F3BUL & RNG_MASK;
+   ulValue = ((ulValue >> 16) ^ ulValue) * 0x45D9F3BUL & RNG_MASK;
+   return (ulValue >> 16) ^ ulValue;
+}
+
+/* Returns a generator seeded with ulSeed.  Any seed is fine. */
+RNG_INLINE Rng_T Rng_make(unsigned long ulSeed) {
+   Rng_T oRng;
+   oRng.ulState = Rng_hash(ulSeed);
+   if (oRng.ulState == 0)
+      oRng.ulState = 1; /* Xorshift never leaves zero. */
+   return oRng;
+}
+
+/* Returns the next 32 random bits from poRng. */
+RNG_INLINE unsigned long Rng_next(Rng_T* poRng) {
+   unsigned long x = poRng->ulState;
+   x ^= (x << 13) & RNG_MASK;
+   x ^= x >> 17;
+   x ^= (x << 5) & RNG_MASK;
+   poRng->ulState = x;
+   return x;
+}
+
+/* Returns a random double from poRng in [0, 1). */
+RNG_INLINE double Rng_uniform(Rng_T* poRng) {
+   return Rng_next(poRng) * (1.0 / 4294967296.0);
+}
+
+/* Returns a random int from poRng in [0, iBound).  It is a checked runtime
+   error for iBound not to be positive. */
+RNG_INLINE int Rng_below(Rng_T* poRng, int iBound) {
+   assert(iBound > 0);
+   return (int)(Rng_uniform(poRng) * iBound);
+}
+
+/* Fills pdOut with iCount random doubles from poRng in [0, 1).  It is a
+   checked runtime error for poRng or pdOut to be NULL. */
+void Rng_fillUniform(Rng_T* poRng, double* pdOut, int iCount);
+
+#endif
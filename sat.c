@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: sat.c defines the implementation for the separating axis
+ *    test between oriented boxes.
+ ___________________________________________________________________________*/
+
+#include "sat.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SAT_LANES 4
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SAT_LANES 2
+#else
+#define SAT_LANES 1
+#endif
+
+/* Both boxes have orthogonal axes, so the dot products between the axes of
+   one box and the axes of the other all come down to the cosine c and sine
+   s of the angle between them.  Projected onto each of the four candidate
+   axes, the boxes are separated if the distance between centers is more
+   than the sum of the projected extents:
+
+      x-axis of 1:  |T.u1| > e1x + e2x|c| + e2y|s|
+      y-axis of 1:  |T.v1| > e1y + e2x|s| + e2y|c|
+      x-axis of 2:  |T.u2| > e2x + e1x|c| + e1y|s|
+      y-axis of 2:  |T.v2| > e2y + e1x|s| + e1y|c|
+
+   where T is the vector between centers. */
+
+/* Returns 1 if the boxes pdBox1 and pdBox2 overlap, and zero otherwise.  It
+   is a checked runtime error for pdBox1 or pdBox2 to be NULL. */
+int Sat_overlap(const double* pdBox1, const double* pdBox2) {
+   double dTX, dTY, dU1X, dU1Y, dU2X, dU2Y, dC, dS;
+   double dE1X, dE1Y, dE2X, dE2Y;
+
+   assert(pdBox1 != NULL && pdBox2 != NULL);
+
+   dTX = pdBox2[SAT_CENTER_X] - pdBox1[SAT_CENTER_X];
+   dTY = pdBox2[SAT_CENTER_Y] - pdBox1[SAT_CENTER_Y];
+   dU1X = pdBox1[SAT_AXIS_X];
+   dU1Y = pdBox1[SAT_AXIS_Y];
+   dU2X = pdBox2[SAT_AXIS_X];
+   dU2Y = pdBox2[SAT_AXIS_Y];
+   dE1X = pdBox1[SAT_EXTENT_X];
+   dE1Y = pdBox1[SAT_EXTENT_Y];
+   dE2X = pdBox2[SAT_EXTENT_X];
+   dE2Y = pdBox2[SAT_EXTENT_Y];
+
+   dC = fabs(dU1X * dU2X + dU1Y * dU2Y);
+   dS = fabs(dU1X * dU2Y - dU1Y * dU2X);
+
+   /* Evaluate all four axes and combine them without branching. */
+   return !((fabs(dTX * dU1X + dTY * dU1Y) > dE1X + dE2X * dC + dE2Y * dS) |
+            (fabs(dTY * dU1X - dTX * dU1Y) > dE1Y + dE2X * dS + dE2Y * dC) |
+            (fabs(dTX * dU2X + dTY * dU2Y) > dE2X + dE1X * dC + dE1Y * dS) |
+            (fabs(dTY * dU2X - dTX * dU2Y) > dE2Y + dE1X * dS + dE1Y * dC));
+}
+
+/* Tests pdBox against every box in poBoxes, setting pcResult[i] to 1 if it
+   overlaps box i and to zero otherwise.  Returns the number of boxes that
+   overlap.  Uses AVX or SSE2 when the compiler targets them.  It is a
+   checked runtime error for any argument to be NULL. */
+int Sat_overlapMany(const double* pdBox, const SatBoxes_T* poBoxes,
+                    unsigned char* pcResult) {
+   double adBox[SAT_BOX_SIZE];
+   int i = 0, iHits = 0;
+
+   assert(pdBox != NULL && poBoxes != NULL && pcResult != NULL);
+
+#if SAT_LANES == 4
+   {
+      /* Absolute values clear the sign bit by andnot with -0.0. */
+      const __m256d vSign = _mm256_set1_pd(-0.0);
+      __m256d vCX = _mm256_set1_pd(pdBox[SAT_CENTER_X]);
+      __m256d vCY = _mm256_set1_pd(pdBox[SAT_CENTER_Y]);
+      __m256d vU1X = _mm256_set1_pd(pdBox[SAT_AXIS_X]);
+      __m256d vU1Y = _mm256_set1_pd(pdBox[SAT_AXIS_Y]);
+      __m256d vE1X = _mm256_set1_pd(pdBox[SAT_EXTENT_X]);
+      __m256d vE1Y = _mm256_set1_pd(pdBox[SAT_EXTENT_Y]);
+      __m256d vTX, vTY, vU2X, vU2Y, vE2X, vE2Y, vC, vS, vSep;
+      int j, iMask;
+
+      for (; i + 4 <= poBoxes->iCount; i += 4) {
+         vTX = _mm256_sub_pd(_mm256_loadu_pd(poBoxes->pdCenterX + i), vCX);
+         vTY = _mm256_sub_pd(_mm256_loadu_pd(poBoxes->pdCenterY + i), vCY);
+         vU2X = _mm256_loadu_pd(poBoxes->pdAxisX + i);
+         vU2Y = _mm256_loadu_pd(poBoxes->pdAxisY + i);
+         vE2X = _mm256_loadu_pd(poBoxes->pdExtentX + i);
+         vE2Y = _mm256_loadu_pd(poBoxes->pdExtentY + i);
+
+         vC = _mm256_andnot_pd(vSign, _mm256_add_pd(_mm256_mul_pd(vU1X, vU2X),
+                                                _mm256_mul_pd(vU1Y, vU2Y)));
+         vS = _mm256_andnot_pd(vSign, _mm256_sub_pd(_mm256_mul_pd(vU1X, vU2Y),
+                                                _mm256_mul_pd(vU1Y, vU2X)));
+
+         vSep = _mm256_cmp_pd(
+            _mm256_andnot_pd(vSign, _mm256_add_pd(_mm256_mul_pd(vTX, vU1X),
+                                              _mm256_mul_pd(vTY, vU1Y))),
+            _mm256_add_pd(vE1X, _mm256_add_pd(_mm256_mul_pd(vE2X, vC),
+                                              _mm256_mul_pd(vE2Y, vS))),
+            _CMP_GT_OQ);
+         vSep = _mm256_or_pd(vSep, _mm256_cmp_pd(
+            _mm256_andnot_pd(vSign, _mm256_sub_pd(_mm256_mul_pd(vTY, vU1X),
+                                              _mm256_mul_pd(vTX, vU1Y))),
+            _mm256_add_pd(vE1Y, _mm256_add_pd(_mm256_mul_pd(vE2X, vS),
+                                              _mm256_mul_pd(vE2Y, vC))),
+            _CMP_GT_OQ));
+         vSep = _mm256_or_pd(vSep, _mm256_cmp_pd(
+            _mm256_andnot_pd(vSign, _mm256_add_pd(_mm256_mul_pd(vTX, vU2X),
+                                              _mm256_mul_pd(vTY, vU2Y))),
+            _mm256_add_pd(vE2X, _mm256_add_pd(_mm256_mul_pd(vE1X, vC),
+                                              _mm256_mul_pd(vE1Y, vS))),
+            _CMP_GT_OQ));
+         vSep = _mm256_or_pd(vSep, _mm256_cmp_pd(
+            _mm256_andnot_pd(vSign, _mm256_sub_pd(_mm256_mul_pd(vTY, vU2X),
+                                              _mm256_mul_pd(vTX, vU2Y))),
+            _mm256_add_pd(vE2Y, _mm256_add_pd(_mm256_mul_pd(vE1X, vS),
+                                              _mm256_mul_pd(vE1Y, vC))),
+            _CMP_GT_OQ));
+
+         iMask = _mm256_movemask_pd(vSep);
+         for (j = 0; j < 4; j++) {
+            pcResult[i + j] = !((iMask >> j) & 1);
+            iHits += pcResult[i + j];
+         }
+      }
+   }
+#elif SAT_LANES == 2
+   {
+      /* Absolute values clear the sign bit by andnot with -0.0. */
+      const __m128d vSign = _mm_set1_pd(-0.0);
+      __m128d vCX = _mm_set1_pd(pdBox[SAT_CENTER_X]);
+      __m128d vCY = _mm_set1_pd(pdBox[SAT_CENTER_Y]);
+      __m128d vU1X = _mm_set1_pd(pdBox[SAT_AXIS_X]);
+      __m128d vU1Y = _mm_set1_pd(pdBox[SAT_AXIS_Y]);
+      __m128d vE1X = _mm_set1_pd(pdBox[SAT_EXTENT_X]);
+      __m128d vE1Y = _mm_set1_pd(pdBox[SAT_EXTENT_Y]);
+      __m128d vTX, vTY, vU2X, vU2Y, vE2X, vE2Y, vC, vS, vSep;
+      int j, iMask;
+
+      for (; i + 2 <= poBoxes->iCount; i += 2) {
+         vTX = _mm_sub_pd(_mm_loadu_pd(poBoxes->pdCenterX + i), vCX);
+         vTY = _mm_sub_pd(_mm_loadu_pd(poBoxes->pdCenterY + i), vCY);
+         vU2X = _mm_loadu_pd(poBoxes->pdAxisX + i);
+         vU2Y = _mm_loadu_pd(poBoxes->pdAxisY + i);
+         vE2X = _mm_loadu_pd(poBoxes->pdExtentX + i);
+         vE2Y = _mm_loadu_pd(poBoxes->pdExtentY + i);
+
+         vC = _mm_andnot_pd(vSign, _mm_add_pd(_mm_mul_pd(vU1X, vU2X),
+                                          _mm_mul_pd(vU1Y, vU2Y)));
+         vS = _mm_andnot_pd(vSign, _mm_sub_pd(_mm_mul_pd(vU1X, vU2Y),
+                                          _mm_mul_pd(vU1Y, vU2X)));
+
+         vSep = _mm_cmpgt_pd(
+            _mm_andnot_pd(vSign, _mm_add_pd(_mm_mul_pd(vTX, vU1X),
+                                        _mm_mul_pd(vTY, vU1Y))),
+            _mm_add_pd(vE1X, _mm_add_pd(_mm_mul_pd(vE2X, vC),
+                                        _mm_mul_pd(vE2Y, vS))));
+         vSep = _mm_or_pd(vSep, _mm_cmpgt_pd(
+            _mm_andnot_pd(vSign, _mm_sub_pd(_mm_mul_pd(vTY, vU1X),
+                                        _mm_mul_pd(vTX, vU1Y))),
+            _mm_add_pd(vE1Y, _mm_add_pd(_mm_mul_pd(vE2X, vS),
+                                        _mm_mul_pd(vE2Y, vC)))));
+         vSep = _mm_or_pd(vSep, _mm_cmpgt_pd(
+            _mm_andnot_pd(vSign, _mm_add_pd(_mm_mul_pd(vTX, vU2X),
+                                        _mm_mul_pd(vTY, vU2Y))),
+            _mm_add_pd(vE2X, _mm_add_pd(_mm_mul_pd(vE1X, vC),
+                                        _mm_mul_pd(vE1Y, vS)))));
+         vSep = _mm_or_pd(vSep, _mm_cmpgt_pd(
+            _mm_andnot_pd(vSign, _mm_sub_pd(_mm_mul_pd(vTY, vU2X),
+                                        _mm_mul_pd(vTX, vU2Y))),
+            _mm_add_pd(vE2Y, _mm_add_pd(_mm_mul_pd(vE1X, vS),
+                                        _mm_mul_pd(vE1Y, vC)))));
+
+         iMask = _mm_movemask_pd(vSep);
+         for (j = 0; j < 2; j++) {
+            pcResult[i + j] = !((iMask >> j) & 1);
+            iHits += pcResult[i + j];
+         }
+      }
+   }
+#endif
+
+   /* Whatever is left over goes through the scalar test. */
+   for (; i < poBoxes->iCount; i++) {
+      adBox[SAT_CENTER_X] = poBoxes->pdCenterX[i];
+      adBox[SAT_CENTER_Y] = poBoxes->pdCenterY[i];
+      adBox[SAT_AXIS_X] = poBoxes->pdAxisX[i];
+      adBox[SAT_AXIS_Y] = poBoxes->pdAxisY[i];
+      adBox[SAT_EXTENT_X] = poBoxes->pdExtentX[i];
+      adBox[SAT_EXTENT_Y] = poBoxes->pdExtentY[i];
+      pcResult[i] = (unsigned char)Sat_overlap(pdBox, adBox);
+      iHits += pcResult[i];
+   }
+
+   return iHits;
+}
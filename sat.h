@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: sat.h defines the interface for the separating axis test
+ *    between oriented boxes.  Boxes are passed as packed doubles so the
+ *    test never allocates.
+ ___________________________________________________________________________*/
+
+#ifndef SAT_H
+#define SAT_H
+
+/* A box is packed into SAT_BOX_SIZE doubles, indexed as below.  The axis is
+   the unit x-axis of the box; its y-axis is the x-axis turned a quarter turn
+   counterclockwise.  The extents are the half widths along each axis. */
+#define SAT_CENTER_X 0
+#define SAT_CENTER_Y 1
+#define SAT_AXIS_X   2
+#define SAT_AXIS_Y   3
+#define SAT_EXTENT_X 4
+#define SAT_EXTENT_Y 5
+#define SAT_BOX_SIZE 6
+
+/* Many boxes, with each field in its own array so they can be tested
+   several at a time. */
+typedef struct SatBoxes {
+       const double* pdCenterX;
+       const double* pdCenterY;
+       const double* pdAxisX;
+       const double* pdAxisY;
+       const double* pdExtentX;
+       const double* pdExtentY;
+       int iCount;
+       } SatBoxes_T;
+
+/* Returns 1 if the boxes pdBox1 and pdBox2 overlap, and zero otherwise.  It
+   is a checked runtime error for pdBox1 or pdBox2 to be NULL. */
+int Sat_overlap(const double* pdBox1, const double* pdBox2);
+
+/* Tests pdBox against every box in poBoxes, setting pcResult[i] to 1 if it
+   overlaps box i and to zero otherwise.  Returns the number of boxes that
+   overlap.  Uses AVX or SSE2 when the compiler targets them.  It is a
+   checked runtime error for any argument to be NULL. */
+int Sat_overlapMany(const double* pdBox, const SatBoxes_T* poBoxes,
+                    unsigned char* pcResult);
+
+#endif
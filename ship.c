@@ -35,6 +35,9 @@
 #include "particlesys.h"
 #include "engine.h"
 #include "timer.h"
+#include "grid.h"
+#include "rng.h"
+#include "render.h"
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
@@ -42,12 +45,42 @@
 
 #define MAX_LINE_LENGTH 100
 #define SLOW_FACTOR 0.3
+#define ROTATION_KP 300      /* Follow gains for classes without their own. */
+#define ROTATION_KI 0.01
+#define ROTATION_KD 0.00001
+#define POSITION_KP 800
+#define POSITION_KI 2
+#define POSITION_KD 0.05
+#define TURN_DEADBAND 50     /* Smaller turn corrections are let go. */
+#define TRAIL_DISTANCE 750   /* How far behind its leader a follower aims. */
+#define GRID_CELL_SIZE 512   /* A bit bigger than the ships we have. */
+#define MAX_BOUNDS_DEPTH 64  /* Deepest pair of bound trees we can walk. */
+
+/* A node in a ship's tree of bounding circles.  Leaves hold one rect each;
+   every other node has a circle holding both its children.  Everything is
+   in body space, so the tree is built once and never needs refitting. */
+struct BoundNode {
+       Vec2_T oCenter;
+       double dRadius;
+       int iLeft;   /* Children, or -1 for a leaf. */
+       int iRight;
+       Rect_T iRect; /* The rect, for a leaf. */
+       };
+
+/* The broad phase.  Every ship is kept in this grid as a circle about its
+   center, so finding ships that might touch does not mean testing every
+   pair. */
+static Grid_T oBroadPhase;
+
+/* Seed for the next ship made.  Each ship's engines get their own seeds
+   from it. */
+static unsigned long ulNextSeed;
 
 /* Structure to store the ship datatype. */
 struct Ship {
-       /* Array of rectangles, pointers to the engine rectangles, and the
-          individual forces for each engine. */
-       Rect_T* poRectArray;
+       /* Range of rectangles in the rect store, pointers to the engines,
+          and the individual forces for each engine. */
+       Rect_T iFirstRect; /* First of the ship's Rects in the store. */
        Engine_T* poEngines;
        int iNumRects; /* Number of Rects in the ship. */
        int iNumEngines; /* Number of engines in the ship. */
@@ -63,8 +96,29 @@ struct Ship {
        double dMaxOmega;
        double dMaxSpeed;
 
-       /* Foward Direction */
-       Vector_T oFoward;
+       /* Position and orientation.  The rects are laid out in body space
+          relative to this, so moving the ship only ever touches the pose.
+          The foward direction is body space (0, 1).  The pose before the
+          last step is kept too, so drawing can blend between the two. */
+       Pose_T oPose;
+       Pose_T oLastPose;
+
+       /* The outline drawn for the ship: the body space corners of every
+          rect, and pairs of corners to draw lines between.  It is built
+          once, since the rects never move in body space, and each frame
+          moves it into world space in pdWorldX and pdWorldY. */
+       double* pdOutlineX;
+       double* pdOutlineY;
+       double* pdWorldX;
+       double* pdWorldY;
+       int iNumVertices;
+       int* piEdges;
+       int iNumEdges;
+
+       /* Tree of bounding circles over the rects, root first, and the
+          handle of the ship's bounding circle in the broad phase. */
+       struct BoundNode* poBounds;
+       int iGridEntry;
 
        /* Mass and moment of inertia. */
        double dMass;
@@ -73,20 +127,151 @@ struct Ship {
        /* Color (could be changed to an array of individual colors). */
        Color_T iColor;
 
-       /* Time of last update. */
-       Time_T iLastUpdate;
-
        /* Last update t units. */
        double dLastTLength;
 
-       /* Needed for the PID controllers for following... can't think of
-          anywhere better to put these. */
-       double lastErrorRot;
-       double lastLastErrorRot;
-       double lastErrorPos;
-       double lastLastErrorPos;
+       /* Gains of the controllers that steer the ship when it follows
+          another, which are kept with whoever runs them. */
+       PidGains_T oRotationGains;
+       PidGains_T oPositionGains;
        };
 
+/* In house function for building the subtree of oShip's bounding circles
+   over the iCount rects in piRects, starting at node *piNext.  Returns the
+   index of the subtree's root. */
+static int Ship_buildBoundsRange(Ship_T oShip, Rect_T* piRects, int iCount,
+                                 int* piNext) {
+   struct BoundNode* poNode;
+   struct BoundNode *poLeft, *poRight;
+   Vec2_T oMin, oMax, oOffset, oDiff;
+   double dExtX, dExtY, dDist;
+   int iNode, iAxis, i, j;
+   Rect_T iSwap;
+
+   iNode = (*piNext)++;
+   poNode = &oShip->poBounds[iNode];
+
+   if (iCount == 1) {
+      dExtX = Rect_getXExt(piRects[0]);
+      dExtY = Rect_getYExt(piRects[0]);
+      poNode->oCenter = Rect_getOffset(piRects[0]);
+      poNode->dRadius = sqrt(dExtX * dExtX + dExtY * dExtY);
+      poNode->iLeft = poNode->iRight = -1;
+      poNode->iRect = piRects[0];
+      return iNode;
+   }
+
+   /* Split the rects in half along whichever axis their centers are most
+      spread out on. */
+   oMin = oMax = Rect_getOffset(piRects[0]);
+   for (i = 1; i < iCount; i++) {
+      oOffset = Rect_getOffset(piRects[i]);
+      if (oOffset.dX < oMin.dX) oMin.dX = oOffset.dX;
+      if (oOffset.dY < oMin.dY) oMin.dY = oOffset.dY;
+      if (oOffset.dX > oMax.dX) oMax.dX = oOffset.dX;
+      if (oOffset.dY > oMax.dY) oMax.dY = oOffset.dY;
+   }
+   iAxis = (oMax.dX - oMin.dX >= oMax.dY - oMin.dY) ? 0 : 1;
+   for (i = 1; i < iCount; i++) {
+      for (j = i; j > 0; j--) {
+         if (iAxis == 0 ? Rect_getOffset(piRects[j - 1]).dX <=
+                          Rect_getOffset(piRects[j]).dX
+                        : Rect_getOffset(piRects[j - 1]).dY <=
+                          Rect_getOffset(piRects[j]).dY)
+            break;
+         iSwap = piRects[j];
+         piRects[j] = piRects[j - 1];
+         piRects[j - 1] = iSwap;
+      }
+   }
+
+   poNode->iRect = RECT_NONE;
+   poNode->iLeft = Ship_buildBoundsRange(oShip, piRects, iCount / 2, piNext);
+   poNode->iRight = Ship_buildBoundsRange(oShip, piRects + iCount / 2,
+                                          iCount - iCount / 2, piNext);
+
+   /* The smallest circle holding both children's circles. */
+   poLeft = &oShip->poBounds[poNode->iLeft];
+   poRight = &oShip->poBounds[poNode->iRight];
+   oDiff = Vec2_diff(poRight->oCenter, poLeft->oCenter);
+   dDist = Vec2_length(oDiff);
+   if (dDist + poRight->dRadius <= poLeft->dRadius) {
+      poNode->oCenter = poLeft->oCenter;
+      poNode->dRadius = poLeft->dRadius;
+   }
+   else if (dDist + poLeft->dRadius <= poRight->dRadius) {
+      poNode->oCenter = poRight->oCenter;
+      poNode->dRadius = poRight->dRadius;
+   }
+   else {
+      poNode->dRadius = (dDist + poLeft->dRadius + poRight->dRadius) / 2;
+      poNode->oCenter = Vec2_sum(poLeft->oCenter,
+                                 Vec2_scale(oDiff, (poNode->dRadius -
+                                                    poLeft->dRadius) / dDist));
+   }
+
+   return iNode;
+}
+
+/* In house function for building the tree of bounding circles over the
+   rects of oShip.  Must be called again if the rects are laid out anew. */
+static void Ship_buildBounds(Ship_T oShip) {
+   Rect_T* piRects;
+   int i, iNext = 0;
+
+   piRects = (Rect_T*)malloc(oShip->iNumRects * sizeof(Rect_T));
+   assert(piRects != NULL);
+   for (i = 0; i < oShip->iNumRects; i++)
+      piRects[i] = oShip->iFirstRect + i;
+
+   oShip->poBounds = (struct BoundNode*)malloc((2 * oShip->iNumRects - 1) *
+                                               sizeof(struct BoundNode));
+   assert(oShip->poBounds != NULL);
+   Ship_buildBoundsRange(oShip, piRects, oShip->iNumRects, &iNext);
+
+   free(piRects);
+}
+
+/* In house function for building the outline of oShip from its rects: four
+   body space corners a rect, with an edge from each corner to the next
+   round the rect.  Must be called again if the rects are laid out anew. */
+static void Ship_buildOutline(Ship_T oShip) {
+   Vec2_T aoCorners[4];
+   Pose_T oBody = Pose_make(0, 0, 0);
+   int i, j, iVertex;
+
+   /* One block holds the body and world space coordinates. */
+   oShip->iNumVertices = 4 * oShip->iNumRects;
+   oShip->pdOutlineX = (double*)malloc((4 * oShip->iNumVertices + 1) *
+                                       sizeof(double));
+   assert(oShip->pdOutlineX != NULL);
+   oShip->pdOutlineY = oShip->pdOutlineX + oShip->iNumVertices;
+   oShip->pdWorldX = oShip->pdOutlineY + oShip->iNumVertices;
+   oShip->pdWorldY = oShip->pdWorldX + oShip->iNumVertices;
+
+   oShip->iNumEdges = oShip->iNumVertices;
+   oShip->piEdges = (int*)malloc((2 * oShip->iNumEdges + 1) * sizeof(int));
+   assert(oShip->piEdges != NULL);
+
+   for (i = 0; i < oShip->iNumRects; i++) {
+      Rect_getCorners(oShip->iFirstRect + i, oBody, aoCorners);
+      for (j = 0; j < 4; j++) {
+         iVertex = 4 * i + j;
+         oShip->pdOutlineX[iVertex] = aoCorners[j].dX;
+         oShip->pdOutlineY[iVertex] = aoCorners[j].dY;
+         oShip->piEdges[2 * iVertex] = iVertex;
+         oShip->piEdges[2 * iVertex + 1] = 4 * i + (j + 1) % 4;
+      }
+   }
+}
+
+/* Seeds the scene.  Every ship made after this takes its own seed from
+   ulSeed and how many ships came before it, so the same seed and the same
+   ships, made in the same order, give the same run. */
+void Ship_seed(unsigned long ulSeed) {
+   ulNextSeed = ulSeed;
+}
+
 /* Returns a new ship created from the parameters specified in sFilename.
    The input format is described in the ship.c */
 Ship_T Ship_new(char* sFilename) {
@@ -96,6 +281,8 @@ Ship_T Ship_new(char* sFilename) {
    int r, g, b; /* The colors. */
    char dummyString[MAX_LINE_LENGTH]; /* Used to skip lines. */
    double xext, yext, xoffs, yoffs, theta, mass, thrust;
+   double kp, ki, kd, kp2, ki2, kd2; /* Follow gains. */
+   Rng_T oSeeds = Rng_make(ulNextSeed++); /* Seeds for the engines. */
 
    /* Open the stream. */
    inputStream = fopen(sFilename, "r");
@@ -113,9 +300,8 @@ Ship_T Ship_new(char* sFilename) {
    oNewShip = (Ship_T)malloc(sizeof(struct Ship));
    assert(oNewShip != NULL);
 
-   /* Allocate space for the array of rectangles, and store how many. */
-   oNewShip->poRectArray = (Rect_T*)malloc(num * sizeof(Rect_T));
-   assert(oNewShip->poRectArray != NULL);
+   /* Reserve a contiguous range of rectangles, and store how many. */
+   oNewShip->iFirstRect = Rect_newRange(num);
    oNewShip->iNumRects = num;
 
    /* Allocate space for the array of engines, and store how many. */
@@ -130,9 +316,9 @@ Ship_T Ship_new(char* sFilename) {
    for(i = 0; i < (num - numEngines); i++) {
       fscanf(inputStream, "%lf %lf %lf %lf %lf %lf\n", &xext, &yext,
              &xoffs, &yoffs, &theta, &mass);
-      oNewShip->poRectArray[i] = Rect_new(xext, yext, mass);
-      Rect_translateRect(oNewShip->poRectArray[i], xoffs, yoffs);
-      Rect_rotateRect(oNewShip->poRectArray[i], theta);
+      Rect_init(oNewShip->iFirstRect + i, xext, yext, mass);
+      Rect_translateRect(oNewShip->iFirstRect + i, xoffs, yoffs);
+      Rect_rotateRect(oNewShip->iFirstRect + i, theta);
    }
 
    /* Skip the precurser to the engines list. */
@@ -143,12 +329,13 @@ Ship_T Ship_new(char* sFilename) {
    for(i = 0; i < numEngines; i++) {
       fscanf(inputStream, "%lf %lf %lf %lf %lf %lf %lf\n", &xext, &yext,
              &xoffs, &yoffs, &theta, &mass, &thrust);
-      oNewShip->poRectArray[i + num - numEngines] = Rect_new(xext, yext, mass);
-      Rect_translateRect(oNewShip->poRectArray[i + num - numEngines],
+      Rect_init(oNewShip->iFirstRect + i + num - numEngines, xext, yext, mass);
+      Rect_translateRect(oNewShip->iFirstRect + i + num - numEngines,
                          xoffs, yoffs);
-      Rect_rotateRect(oNewShip->poRectArray[i + num - numEngines], theta);
+      Rect_rotateRect(oNewShip->iFirstRect + i + num - numEngines, theta);
 
-      oNewShip->poEngines[i] = Engine_new(oNewShip->poRectArray[i + num - numEngines], thrust);
+      oNewShip->poEngines[i] = Engine_new(oNewShip->iFirstRect + i + num - numEngines, thrust,
+                                          Rng_next(&oSeeds));
    }
 
    /* Skip the precurser to the color. */
@@ -164,6 +351,18 @@ Ship_T Ship_new(char* sFilename) {
    /* Get the max speeds. */
    fscanf(inputStream, "%lf %lf\n", &oNewShip->dMaxSpeed, &oNewShip->dMaxOmega);
 
+   /* Get the follow gains, if the class has its own. */
+   oNewShip->oRotationGains = PidGains_make(ROTATION_KP, ROTATION_KI,
+                                            ROTATION_KD);
+   oNewShip->oPositionGains = PidGains_make(POSITION_KP, POSITION_KI,
+                                            POSITION_KD);
+   if (fgets(dummyString, MAX_LINE_LENGTH, inputStream) != NULL &&
+       fscanf(inputStream, "%lf %lf %lf %lf %lf %lf", &kp, &ki, &kd,
+              &kp2, &ki2, &kd2) == 6) {
+      oNewShip->oRotationGains = PidGains_make(kp, ki, kd);
+      oNewShip->oPositionGains = PidGains_make(kp2, ki2, kd2);
+   }
+
    /* Close the input stream. */
    fclose(inputStream);
 
@@ -172,19 +371,23 @@ Ship_T Ship_new(char* sFilename) {
    Ship_setMassMoment(oNewShip);
 
    /* Initialize direction and motion vectors. */
-   oNewShip->oFoward = Vector_new(0, 1);
+   oNewShip->oPose = Pose_make(0, 0, 0);
+   oNewShip->oLastPose = oNewShip->oPose;
+
+   /* Build the outline and the bounding circles, and enter the ship in the
+      broad phase. */
+   Ship_buildOutline(oNewShip);
+   Ship_buildBounds(oNewShip);
+   if (oBroadPhase == NULL)
+      oBroadPhase = Grid_new(GRID_CELL_SIZE);
+   oNewShip->iGridEntry = Grid_insert(oBroadPhase, oNewShip, 0, 0,
+                                      Vec2_length(oNewShip->poBounds[0].oCenter)
+                                      + oNewShip->poBounds[0].dRadius);
    oNewShip->dXAc = oNewShip->dYAc = oNewShip->dAlpha = 0;
    oNewShip->dXVel = oNewShip->dYVel = oNewShip->dOmega = 0;
 
    /* Initialize timing values. */
-   oNewShip->iLastUpdate = Timer_getTime();
-   oNewShip->dLastTLength = 0;
-
-   /* Initialize error values for PID control. */
-   oNewShip->lastErrorRot = 0;
-   oNewShip->lastLastErrorRot = 0;
-   oNewShip->lastErrorPos = 0;
-   oNewShip->lastLastErrorPos = 0;
+   oNewShip->dLastTLength = Timer_getStep();
 
    return oNewShip;
 }
@@ -194,43 +397,40 @@ void Ship_free(Ship_T oShip) {
    int i;
    if (oShip == NULL) return;
 
-   for(i = 0; i < oShip->iNumRects; i++) {
-      Rect_free(oShip->poRectArray[i]);
-   }
+   Rect_freeRange(oShip->iFirstRect, oShip->iNumRects);
+   Grid_remove(oBroadPhase, oShip->iGridEntry);
+   free(oShip->poBounds);
+   free(oShip->pdOutlineX);
+   free(oShip->piEdges);
 
    for(i = 0; i < oShip->iNumEngines; i++) {
       Engine_free(oShip->poEngines[i]);
    }
 
-   Vector_free(oShip->oFoward);
-
    free(oShip->poEngines);
-   free(oShip->poRectArray);
    free(oShip);
 }
 
 /* Translates oShip by (dX, dY).  It is a checked runtime error for oShip to be
    NULL. */
 void Ship_translate(Ship_T oShip, double dX, double dY) {
-   int i;
    assert(oShip != NULL);
-
-   for(i = 0; i < oShip->iNumRects; i++) {
-      Rect_translateObj(oShip->poRectArray[i], dX, dY);
-   }
+   oShip->oPose.oPos = Vec2_sum(oShip->oPose.oPos, Vec2_make(dX, dY));
+   oShip->oLastPose.oPos = Vec2_sum(oShip->oLastPose.oPos, Vec2_make(dX, dY));
+   Grid_move(oBroadPhase, oShip->iGridEntry, oShip->oPose.oPos.dX,
+             oShip->oPose.oPos.dY);
 }
 
 /* Rotates oShip by dTheta.  It is a checked runtime error for oShip to be
    NULL. */
 void Ship_rotate(Ship_T oShip, double dTheta) {
-   int i;
    assert(oShip != NULL);
 
-   Vector_rotate(oShip->oFoward, dTheta);
-
-   for(i = 0; i < oShip->iNumRects; i++) {
-      Rect_rotateObj(oShip->poRectArray[i], dTheta);
-   }
+   oShip->oPose = Pose_make(oShip->oPose.oPos.dX, oShip->oPose.oPos.dY,
+                            oShip->oPose.dTheta + dTheta);
+   oShip->oLastPose = Pose_make(oShip->oLastPose.oPos.dX,
+                                oShip->oLastPose.oPos.dY,
+                                oShip->oLastPose.dTheta + dTheta);
 }
 
 /* Recenters oShip about its current center of mass.  It is a checked
@@ -238,24 +438,23 @@ void Ship_rotate(Ship_T oShip, double dTheta) {
 void Ship_recenter(Ship_T oShip) {
    double totMass = 0, xMass = 0, yMass = 0, deltX = 0, deltY = 0;
    int i;
-   Vector_T currVector;
 
    assert(oShip != NULL);
 
    for(i = 0; i < oShip->iNumRects; i++) {
-      totMass += Rect_getMass(oShip->poRectArray[i]);
-      xMass += Rect_getMass(oShip->poRectArray[i]) *
-               Vector_getX(Rect_getOffset(oShip->poRectArray[i]));
-      yMass += Rect_getMass(oShip->poRectArray[i]) *
-               Vector_getY(Rect_getOffset(oShip->poRectArray[i]));
+      totMass += Rect_getMass(oShip->iFirstRect + i);
+      xMass += Rect_getMass(oShip->iFirstRect + i) *
+               Rect_getOffset(oShip->iFirstRect + i).dX;
+      yMass += Rect_getMass(oShip->iFirstRect + i) *
+               Rect_getOffset(oShip->iFirstRect + i).dY;
    }
    deltX = xMass / totMass;
    deltY = yMass / totMass;
 
    for(i = 0; i < oShip->iNumRects; i++) {
-      currVector = Rect_getOffset(oShip->poRectArray[i]);
-      Vector_setX(currVector, Vector_getX(currVector) - deltX);
-      Vector_setY(currVector, Vector_getY(currVector) - deltY);
+      Rect_setOffset(oShip->iFirstRect + i,
+                     Vec2_diff(Rect_getOffset(oShip->iFirstRect + i),
+                               Vec2_make(deltX, deltY)));
    }
 }
 
@@ -267,8 +466,8 @@ void Ship_setMassMoment(Ship_T oShip) {
    assert(oShip != NULL);
 
    for(i = 0; i < oShip->iNumRects; i++) {
-      moment += Rect_getMoment(oShip->poRectArray[i]);
-      mass += Rect_getMass(oShip->poRectArray[i]);
+      moment += Rect_getMoment(oShip->iFirstRect + i);
+      mass += Rect_getMass(oShip->iFirstRect + i);
    }
    oShip->dMass = mass;
    oShip->dMoment = moment;
@@ -286,16 +485,26 @@ void Ship_applyForce(Ship_T oShip, double fX, double fY, double dX,
 }
 
 /* Applies the ship's current velocities to change its position and
-   rotation.  Operates for duration t. It is a checked runtime error for oShip
-   to be NULL. */
-void Ship_applyVelocities(Ship_T oShip) {
-   double deltX, deltY, deltTheta, t, speedsqr;
+   rotation, and ages its smoke.  Operates for duration t.  It is a checked
+   runtime error for oShip to be NULL. */
+void Ship_applyVelocities(Ship_T oShip, double t) {
+   Ship_integrate(oShip, t);
+   Ship_updateBroadPhase(oShip);
+}
+
+/* Does everything Ship_applyVelocities does but move oShip in the broad
+   phase, which Ship_updateBroadPhase must do before collisions are next
+   looked for.  Nothing but oShip is changed, so several ships may be
+   integrated at once on different threads.  It is a checked runtime error
+   for oShip to be NULL. */
+void Ship_integrate(Ship_T oShip, double t) {
+   double deltX, deltY, deltTheta, speedsqr;
    int i;
 
    assert(oShip != NULL);
 
-   oShip->dLastTLength = t = Timer_getMultiplier(oShip->iLastUpdate);
-   oShip->iLastUpdate = Timer_getTime();
+   oShip->dLastTLength = t;
+   oShip->oLastPose = oShip->oPose;
    oShip->dXVel += oShip->dXAc * t;
    oShip->dYVel += oShip->dYAc * t;
    oShip->dOmega += oShip->dAlpha * t;
@@ -317,13 +526,24 @@ void Ship_applyVelocities(Ship_T oShip) {
 
    oShip->dXAc = oShip->dYAc = oShip->dAlpha = 0;
 
-   Vector_rotate(oShip->oFoward, deltTheta);
-   for(i = 0; i < oShip->iNumRects; i++) {
-      Rect_translateObj(oShip->poRectArray[i], deltX, deltY);
-      Rect_rotateObj(oShip->poRectArray[i], deltTheta);
+   oShip->oPose = Pose_make(oShip->oPose.oPos.dX + deltX,
+                            oShip->oPose.oPos.dY + deltY,
+                            oShip->oPose.dTheta + deltTheta);
+
+   for(i = 0; i < oShip->iNumEngines; i++) {
+      Engine_decaySmoke(oShip->poEngines[i], t);
    }
 }
 
+/* Moves oShip to where it now is in the broad phase that
+   Ship_mapCollisions uses.  It is a checked runtime error for oShip to be
+   NULL. */
+void Ship_updateBroadPhase(Ship_T oShip) {
+   assert(oShip != NULL);
+   Grid_move(oBroadPhase, oShip->iGridEntry, oShip->oPose.oPos.dX,
+             oShip->oPose.oPos.dY);
+}
+
 /* Sets all velocities of oShip equal to a fraction of their value.  It is a
    checked runtime error for oShip to be NULL. */
 void Ship_stopSlow(Ship_T oShip) {
@@ -370,33 +590,63 @@ void Ship_fullLeftThrottle(Ship_T oShip) {
    }
 }
 
-/* Draws oShip to the screen.  It is a checked runtime error for oShip to be
-   NULL. */
-void Ship_draw(Ship_T oShip) {
-   int i;
+/* Records oShip to be drawn this frame, dBlend of the way from its pose
+   before the last step to its current one.  If its bounding circle is off
+   the screen only its smoke, which trails outside the circle, may be
+   recorded.  It is a checked runtime error for oShip to be NULL. */
+void Ship_draw(Ship_T oShip, double dBlend) {
+   Pose_T oPose;
+   Vec2_T oCenter;
+   double dRadius;
+   int i, iFrom, iTo;
    assert(oShip != NULL);
 
-   for(i = 0; i < oShip->iNumRects; i++) {
-      Rect_draw(oShip->poRectArray[i], oShip->iColor);
+   oPose = Pose_lerp(oShip->oLastPose, oShip->oPose, dBlend);
+   oCenter = Pose_transform(oPose, oShip->poBounds[0].oCenter);
+   dRadius = oShip->poBounds[0].dRadius;
+   if (Draw_isVisible(oCenter.dX - dRadius, oCenter.dY - dRadius,
+                      oCenter.dX + dRadius, oCenter.dY + dRadius)) {
+      Pose_transformPoints(oPose, oShip->pdOutlineX, oShip->pdOutlineY,
+                           oShip->iNumVertices, oShip->pdWorldX,
+                           oShip->pdWorldY);
+      for(i = 0; i < oShip->iNumEdges; i++) {
+         iFrom = oShip->piEdges[2 * i];
+         iTo = oShip->piEdges[2 * i + 1];
+         Render_line(oShip->pdWorldX[iFrom], oShip->pdWorldY[iFrom],
+                     oShip->pdWorldX[iTo], oShip->pdWorldY[iTo],
+                     oShip->iColor, RENDER_LAYER_SHIPS);
+      }
    }
    for(i = 0; i < oShip->iNumEngines; i++) {
-      Engine_drawSmoke(oShip->poEngines[i], oShip->dLastTLength);
+      Engine_drawSmoke(oShip->poEngines[i]);
    }
 }
 
-/* Centers the drawing window around oShip.  It is a checked runtime error
+/* Centers the drawing window around oShip, dBlend of the way from its pose
+   before the last step to its current one.  It is a checked runtime error
    for oShip to be NULL. */
-void Ship_centerWindow(Ship_T oShip) {
+void Ship_centerWindow(Ship_T oShip, double dBlend) {
    double speedsquared = oShip->dXVel * oShip->dXVel + oShip->dYVel * oShip->dYVel + 1;
+   Vec2_T oPos;
+   assert(oShip != NULL);
+
+   oPos = Pose_lerp(oShip->oLastPose, oShip->oPose, dBlend).oPos;
    Draw_setScale(500 / (2 * sqrt(speedsquared) + 1000));
-   Draw_shiftToPoint(Vector_getX(Rect_getCenter(oShip->poRectArray[0])), Vector_getY(Rect_getCenter(oShip->poRectArray[0])));
+   Draw_shiftToPoint(oPos.dX, oPos.dY);
 }
 
 /* Returns the center point of oShip.  It is a checked runtime error for oShip
    to be NULL. */
-Vector_T Ship_getCenter(Ship_T oShip) {
+Vec2_T Ship_getCenter(Ship_T oShip) {
+   assert(oShip != NULL);
+   return(oShip->oPose.oPos);
+}
+
+/* Returns the pose of oShip.  It is a checked runtime error for oShip to be
+   NULL. */
+Pose_T Ship_getPose(Ship_T oShip) {
    assert(oShip != NULL);
-   return(Rect_getCenter(oShip->poRectArray[0]));
+   return oShip->oPose;
 }
 
 /* Returns the speed of oShip.  It is a checked runtime error for oShip
@@ -427,101 +677,207 @@ double Ship_getOmega(Ship_T oShip) {
    return oShip->dOmega;
 }
 
-/* Do the ships collide? */
+/* Do the ships collide?  Walks the two trees of bounding circles together,
+   only testing rects whose circles overlap. */
 int Ship_doIntersect(Ship_T oShip1, Ship_T oShip2) {
-   int i, j;
-   for(i = 0; i < oShip1->iNumRects; i++) {
-      for(j = 0; j < oShip2->iNumRects; j++) {
-         if(Rect_doIntersect(oShip1->poRectArray[i], oShip2->poRectArray[j]))
+   int aiStack[2 * MAX_BOUNDS_DEPTH];
+   int iTop = 0;
+   struct BoundNode *poNode1, *poNode2;
+   Vec2_T oDiff;
+   double dRadii;
+
+   assert(oShip1 != NULL && oShip2 != NULL);
+
+   aiStack[iTop++] = 0;
+   aiStack[iTop++] = 0;
+   while (iTop > 0) {
+      poNode2 = &oShip2->poBounds[aiStack[--iTop]];
+      poNode1 = &oShip1->poBounds[aiStack[--iTop]];
+
+      oDiff = Vec2_diff(Pose_transform(oShip2->oPose, poNode2->oCenter),
+                        Pose_transform(oShip1->oPose, poNode1->oCenter));
+      dRadii = poNode1->dRadius + poNode2->dRadius;
+      if (Vec2_dot(oDiff, oDiff) > dRadii * dRadii)
+         continue;
+
+      if (poNode1->iLeft == -1 && poNode2->iLeft == -1) {
+         if (Rect_doIntersect(poNode1->iRect, oShip1->oPose,
+                              poNode2->iRect, oShip2->oPose))
             return 1;
+         continue;
+      }
+
+      /* Open up the bigger of the two circles. */
+      assert(iTop + 4 <= 2 * MAX_BOUNDS_DEPTH);
+      if (poNode2->iLeft == -1 ||
+          (poNode1->iLeft != -1 && poNode1->dRadius >= poNode2->dRadius)) {
+         aiStack[iTop++] = poNode1->iLeft;
+         aiStack[iTop++] = poNode2 - oShip2->poBounds;
+         aiStack[iTop++] = poNode1->iRight;
+         aiStack[iTop++] = poNode2 - oShip2->poBounds;
+      }
+      else {
+         aiStack[iTop++] = poNode1 - oShip1->poBounds;
+         aiStack[iTop++] = poNode2->iLeft;
+         aiStack[iTop++] = poNode1 - oShip1->poBounds;
+         aiStack[iTop++] = poNode2->iRight;
       }
    }
    return 0;
 }
 
-/* These two follow functions use PID controller logic, as found in
-   thermostats and cruise control. */
-/* Simple test AI function. */
-void Ship_followRotation(Ship_T oShip, Ship_T oShip1) {
-   double lastE = oShip->lastErrorRot;
-   double lastLastE = oShip->lastLastErrorRot;
-   double C = 0.0;
-   double error;
-   double time = oShip->dLastTLength;
-   /* Constants for each section. */
-   double KP = 300, KI = 0.01, KD = 0.00001;
-   /* Proportional, integral, derivative, correction */
-   double P, I, D;
-
-   double xDir = Vector_getX(oShip->oFoward);
-   double yDir = Vector_getY(oShip->oFoward);
-
-   double xDiff = Vector_getX(Ship_getCenter(oShip1)) -
-                  Vector_getX(Ship_getCenter(oShip));
-   double yDiff = Vector_getY(Ship_getCenter(oShip1)) -
-                  Vector_getY(Ship_getCenter(oShip));
-
-   /* The error in angle is the cross product between this ships direction
-      and the vector between the ships */
-   error = xDir * yDiff - yDir * xDiff;
-
-   P = (error - lastE);
-   I = KI * time * error;
-   D = KD / time * (error - 2 * lastE + lastLastE);
-
-   C = KP * (P + I + D);
-
-   if(C < -50) {
-      Ship_fullLeftThrottle(oShip);
-   }
-   else if(C > 50) {
-      Ship_fullRightThrottle(oShip);
-   }
-
-   oShip->lastLastErrorRot = lastE;
-   oShip->lastErrorRot = error;
+/* What Ship_mapCollisions passes through the broad phase. */
+struct Collide {
+       void (*pfCollide)(Ship_T oShip1, Ship_T oShip2, void* pvExtra);
+       void* pvExtra;
+       };
 
+/* In house function for running the narrow phase on a pair of ships from
+   the broad phase. */
+static void Ship_collidePair(void* pvShip1, void* pvShip2, void* pvCollide) {
+   struct Collide* poCollide = (struct Collide*)pvCollide;
+   if (Ship_doIntersect((Ship_T)pvShip1, (Ship_T)pvShip2))
+      (*poCollide->pfCollide)((Ship_T)pvShip1, (Ship_T)pvShip2,
+                              poCollide->pvExtra);
 }
 
-/* Simple test AI function. */
-void Ship_followPosition(Ship_T oShip, Ship_T oShip1) {
-   double lastError = oShip->lastErrorPos;
-   double lastLastError = oShip->lastLastErrorPos;
+/* Calls pfCollide once for every pair of ships that collide, passing the
+   two ships and pvExtra.  Only ships whose bounding circles overlap are
+   tested.  It is a checked runtime error for pfCollide to be NULL. */
+void Ship_mapCollisions(void (*pfCollide)(Ship_T oShip1, Ship_T oShip2,
+                                          void* pvExtra),
+                        void* pvExtra) {
+   struct Collide oCollide;
+
+   assert(pfCollide != NULL);
+   if (oBroadPhase == NULL)
+      return;
+
+   oCollide.pfCollide = pfCollide;
+   oCollide.pvExtra = pvExtra;
+   Grid_mapPairs(oBroadPhase, Ship_collidePair, &oCollide);
+}
 
-   double error;
-   double time = oShip->dLastTLength;
-   /* Constants for each section. */
-   double KP = 800, KI = 2, KD = 0.05;
-   /* Proportional, integral, derivative, correction */
-   double P, I, D, C;
+/* Finds the iK ships nearest oShip, leaving out any further than dRange
+   away, using the broad phase.  They go in poShips, nearest first, with
+   the distances between their centers and oShip's in pdDistances, and how
+   many were found is returned.  Ships are where they were last moved in
+   the broad phase.  It is a checked runtime error for any argument to be
+   NULL, for dRange to be negative, or for iK to be negative or more than
+   SHIP_MAX_NEAREST. */
+int Ship_findNearest(Ship_T oShip, double dRange, int iK, Ship_T* poShips,
+                     double* pdDistances) {
+   void* apvFound[SHIP_MAX_NEAREST];
+   int iFound, i;
+
+   assert(oShip != NULL && poShips != NULL && pdDistances != NULL);
+   assert(dRange >= 0 && iK >= 0 && iK <= SHIP_MAX_NEAREST);
+   iFound = Grid_findNearest(oBroadPhase, oShip->oPose.oPos.dX,
+                             oShip->oPose.oPos.dY, dRange, oShip, iK,
+                             apvFound, pdDistances);
+   for (i = 0; i < iFound; i++)
+      poShips[i] = (Ship_T)apvFound[i];
+   return iFound;
+}
 
-   double xDiff = Vector_getX(Ship_getCenter(oShip1)) -
-                  Vector_getX(Ship_getCenter(oShip)) -
-                  750 * oShip1->dXVel / Ship_getSpeed(oShip1);
+/* What Ship_neighbor needs to pass a neighbour on. */
+struct Neighbors {
+       Ship_T oShip;
+       void (*pfNeighbor)(Ship_T oShip, Ship_T oNeighbor, double dDistance,
+                          void* pvExtra);
+       void* pvExtra;
+       };
 
-   double yDiff = Vector_getY(Ship_getCenter(oShip1)) -
-                  Vector_getY(Ship_getCenter(oShip)) -
-                  750 * oShip1->dYVel / Ship_getSpeed(oShip1);
+/* In house function for passing a ship found near another on, unless it
+   is that ship itself. */
+static void Ship_neighbor(void* pvShip, double dDistance,
+                          void* pvNeighbors) {
+   struct Neighbors* poNeighbors = (struct Neighbors*)pvNeighbors;
+   if ((Ship_T)pvShip != poNeighbors->oShip)
+      (*poNeighbors->pfNeighbor)(poNeighbors->oShip, (Ship_T)pvShip,
+                                 dDistance, poNeighbors->pvExtra);
+}
 
-   double vx = Ship_getVX(oShip);
-   double vy = Ship_getVY(oShip);
+/* Calls pfNeighbor once for every other ship whose center is within
+   dRange of oShip's, passing oShip, the other ship, the distance between
+   them and pvExtra, in no particular order.  Ships are where they were
+   last moved in the broad phase.  It is a checked runtime error for oShip
+   or pfNeighbor to be NULL or for dRange to be negative. */
+void Ship_mapNeighbors(Ship_T oShip, double dRange,
+                       void (*pfNeighbor)(Ship_T oShip, Ship_T oNeighbor,
+                                          double dDistance, void* pvExtra),
+                       void* pvExtra) {
+   struct Neighbors oNeighbors;
+
+   assert(oShip != NULL && pfNeighbor != NULL && dRange >= 0);
+   oNeighbors.oShip = oShip;
+   oNeighbors.pfNeighbor = pfNeighbor;
+   oNeighbors.pvExtra = pvExtra;
+   Grid_mapWithin(oBroadPhase, oShip->oPose.oPos.dX, oShip->oPose.oPos.dY,
+                  dRange, Ship_neighbor, &oNeighbors);
+}
 
-   /* The error in position is the distance between the ships */
-   error = sqrt(xDiff * xDiff + yDiff * yDiff);
+/* Works out how far oShip is from following oShip1, changing nothing.
+   *pdRotError is the cross product of oShip's heading and the way to
+   oShip1, and *pdPosError the distance to a point trailing oShip1.
+   *pisAway is set to whether oShip is moving away from that point.  It is
+   a checked runtime error for any argument to be NULL. */
+void Ship_getFollowErrors(Ship_T oShip, Ship_T oShip1, double* pdRotError,
+                          double* pdPosError, int* pisAway) {
+   double xDir, yDir, xDiff, yDiff;
+
+   assert(oShip != NULL && oShip1 != NULL);
+   assert(pdRotError != NULL && pdPosError != NULL && pisAway != NULL);
+
+   xDir = -oShip->oPose.dSin;
+   yDir = oShip->oPose.dCos;
+   xDiff = Ship_getCenter(oShip1).dX - Ship_getCenter(oShip).dX;
+   yDiff = Ship_getCenter(oShip1).dY - Ship_getCenter(oShip).dY;
+   *pdRotError = xDir * yDiff - yDir * xDiff;
+
+   xDiff -= TRAIL_DISTANCE * oShip1->dXVel / Ship_getSpeed(oShip1);
+   yDiff -= TRAIL_DISTANCE * oShip1->dYVel / Ship_getSpeed(oShip1);
+   *pdPosError = sqrt(xDiff * xDiff + yDiff * yDiff);
+   *pisAway = oShip->dXVel * xDiff + oShip->dYVel * yDiff < 0;
+}
 
-   P = (error - lastError);
-   I = KI * time * error;
-   D = KD / time * (error - 2 * lastError + lastLastError);
+/* Steers oShip by the corrections its rotation and position controllers
+   gave for the errors from Ship_getFollowErrors: turning if dRotCorrection
+   is big enough, and closing in if dPosCorrection is positive and it is
+   not moving away, or else slowing down.  Changes nothing but oShip.  It
+   is a checked runtime error for oShip to be NULL. */
+void Ship_steer(Ship_T oShip, double dRotCorrection, double dPosCorrection,
+                int isAway) {
+   assert(oShip != NULL);
 
-   C = KP * (P + I + D);
+   if (dRotCorrection < -TURN_DEADBAND)
+      Ship_fullLeftThrottle(oShip);
+   else if (dRotCorrection > TURN_DEADBAND)
+      Ship_fullRightThrottle(oShip);
 
-   if(C < 0 || vx * xDiff + vy * yDiff < 0) {
+   if (dPosCorrection < 0 || isAway)
       Ship_stopSlow(oShip);
-   }
-   else if(C > 0) {
+   else if (dPosCorrection > 0)
       Ship_fullThrottle(oShip);
-   }
+}
+
+/* Returns the gains oShip's class steers its heading with when following.
+   It is a checked runtime error for oShip to be NULL. */
+PidGains_T Ship_getRotationGains(Ship_T oShip) {
+   assert(oShip != NULL);
+   return oShip->oRotationGains;
+}
+
+/* Returns the gains oShip's class steers its position with when
+   following.  It is a checked runtime error for oShip to be NULL. */
+PidGains_T Ship_getPositionGains(Ship_T oShip) {
+   assert(oShip != NULL);
+   return oShip->oPositionGains;
+}
 
-   oShip->lastLastErrorPos = lastError;
-   oShip->lastErrorPos = error;
+/* Returns the length of oShip's last step, which its follow controllers
+   run over.  It is a checked runtime error for oShip to be NULL. */
+double Ship_getStep(Ship_T oShip) {
+   assert(oShip != NULL);
+   return oShip->dLastTLength;
 }
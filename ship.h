@@ -33,9 +33,17 @@
 
 #include "rect.h"
 #include "draw.h"
+#include "pid.h"
+
+#define SHIP_MAX_NEAREST 16 /* The most ships Ship_findNearest finds. */
 
 typedef struct Ship* Ship_T;
 
+/* Seeds the scene.  Every ship made after this takes its own seed from
+   ulSeed and how many ships came before it, so the same seed and the same
+   ships, made in the same order, give the same run. */
+void Ship_seed(unsigned long ulSeed);
+
 /* Returns a new ship created from the parameters specified in sFilename.
    The input format is described in the sample ships' comments */
 Ship_T Ship_new(char* sFilename);
@@ -65,8 +73,21 @@ void Ship_applyForce(Ship_T oShip, double fX, double fY, double dX,
                        double dY);
 
 /* Applies the ship's current velocities to change its position and
-   rotation.  It is a checked runtime error for oShip to be NULL. */
-void Ship_applyVelocities(Ship_T oShip);
+   rotation, and ages its smoke.  Operates for duration t.  It is a checked
+   runtime error for oShip to be NULL. */
+void Ship_applyVelocities(Ship_T oShip, double t);
+
+/* Does everything Ship_applyVelocities does but move oShip in the broad
+   phase, which Ship_updateBroadPhase must do before collisions are next
+   looked for.  Nothing but oShip is changed, so several ships may be
+   integrated at once on different threads.  It is a checked runtime error
+   for oShip to be NULL. */
+void Ship_integrate(Ship_T oShip, double t);
+
+/* Moves oShip to where it now is in the broad phase that
+   Ship_mapCollisions uses.  It is a checked runtime error for oShip to be
+   NULL. */
+void Ship_updateBroadPhase(Ship_T oShip);
 
 /* Sets all velocities of oShip equal to a fraction of their value.  It is a
    checked runtime error for oShip to be NULL. */
@@ -84,17 +105,24 @@ void Ship_fullRightThrottle(Ship_T oShip);
    error for oShip to be NULL. */
 void Ship_fullLeftThrottle(Ship_T oShip);
 
-/* Draws oShip to the screen.  It is a checked runtime error for oShip to be
-   NULL. */
-void Ship_draw(Ship_T oShip);
+/* Records oShip to be drawn this frame, dBlend of the way from its pose
+   before the last step to its current one.  If its bounding circle is off
+   the screen only its smoke, which trails outside the circle, may be
+   recorded.  It is a checked runtime error for oShip to be NULL. */
+void Ship_draw(Ship_T oShip, double dBlend);
 
-/* Centers the drawing window around oShip.  It is a checked runtime error
+/* Centers the drawing window around oShip, dBlend of the way from its pose
+   before the last step to its current one.  It is a checked runtime error
    for oShip to be NULL. */
-void Ship_centerWindow(Ship_T oShip);
+void Ship_centerWindow(Ship_T oShip, double dBlend);
 
 /* Returns the center point of oShip.  It is a checked runtime error for oShip
    to be NULL. */
-Vector_T Ship_getCenter(Ship_T oShip);
+Vec2_T Ship_getCenter(Ship_T oShip);
+
+/* Returns the pose of oShip.  It is a checked runtime error for oShip to be
+   NULL. */
+Pose_T Ship_getPose(Ship_T oShip);
 
 /* Returns the speed of oShip.  It is a checked runtime error for oShip
    to be NULL. */
@@ -115,10 +143,59 @@ double Ship_getOmega(Ship_T oShip);
 /* Do the ships collide? */
 int Ship_doIntersect(Ship_T oShip1, Ship_T oShip2);
 
-/* Simple test AI function. */
-void Ship_followRotation(Ship_T oShip, Ship_T oShip1);
-
-/* Simple test AI function. */
-void Ship_followPosition(Ship_T oShip, Ship_T oShip1);
+/* Calls pfCollide once for every pair of ships that collide, passing the
+   two ships and pvExtra.  Only ships whose bounding circles overlap are
+   tested.  It is a checked runtime error for pfCollide to be NULL. */
+void Ship_mapCollisions(void (*pfCollide)(Ship_T oShip1, Ship_T oShip2,
+                                          void* pvExtra),
+                        void* pvExtra);
+
+/* Finds the iK ships nearest oShip, leaving out any further than dRange
+   away, using the broad phase.  They go in poShips, nearest first, with
+   the distances between their centers and oShip's in pdDistances, and how
+   many were found is returned.  Ships are where they were last moved in
+   the broad phase.  It is a checked runtime error for any argument to be
+   NULL, for dRange to be negative, or for iK to be negative or more than
+   SHIP_MAX_NEAREST. */
+int Ship_findNearest(Ship_T oShip, double dRange, int iK, Ship_T* poShips,
+                     double* pdDistances);
+
+/* Calls pfNeighbor once for every other ship whose center is within
+   dRange of oShip's, passing oShip, the other ship, the distance between
+   them and pvExtra, in no particular order.  Ships are where they were
+   last moved in the broad phase.  It is a checked runtime error for oShip
+   or pfNeighbor to be NULL or for dRange to be negative. */
+void Ship_mapNeighbors(Ship_T oShip, double dRange,
+                       void (*pfNeighbor)(Ship_T oShip, Ship_T oNeighbor,
+                                          double dDistance, void* pvExtra),
+                       void* pvExtra);
+
+/* Works out how far oShip is from following oShip1, changing nothing.
+   *pdRotError is the cross product of oShip's heading and the way to
+   oShip1, and *pdPosError the distance to a point trailing oShip1.
+   *pisAway is set to whether oShip is moving away from that point.  It is
+   a checked runtime error for any argument to be NULL. */
+void Ship_getFollowErrors(Ship_T oShip, Ship_T oShip1, double* pdRotError,
+                          double* pdPosError, int* pisAway);
+
+/* Steers oShip by the corrections its rotation and position controllers
+   gave for the errors from Ship_getFollowErrors: turning if dRotCorrection
+   is big enough, and closing in if dPosCorrection is positive and it is
+   not moving away, or else slowing down.  Changes nothing but oShip.  It
+   is a checked runtime error for oShip to be NULL. */
+void Ship_steer(Ship_T oShip, double dRotCorrection, double dPosCorrection,
+                int isAway);
+
+/* Returns the gains oShip's class steers its heading with when following.
+   It is a checked runtime error for oShip to be NULL. */
+PidGains_T Ship_getRotationGains(Ship_T oShip);
+
+/* Returns the gains oShip's class steers its position with when
+   following.  It is a checked runtime error for oShip to be NULL. */
+PidGains_T Ship_getPositionGains(Ship_T oShip);
+
+/* Returns the length of oShip's last step, which its follow controllers
+   run over.  It is a checked runtime error for oShip to be NULL. */
+double Ship_getStep(Ship_T oShip);
 
 #endif
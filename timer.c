@@ -31,21 +31,95 @@
 
 #include "timer.h"
 #include <SDL.h>
+#include <assert.h>
+
+/* Milliseconds in a simulation step. */
+#define STEP_TICKS(iFrameRate) (1000 / (iFrameRate))
 
 /* The inverse of the target framerate. */
 static double dInverseRate;
 
+/* Whether the clock is synthetic, and if so what time it says. */
+static int iSynthetic;
+static Time_T iSyntheticTime;
+
+/* The length of a simulation step, when the last frame started, and how
+   much time has been banked towards the next step. */
+static Time_T iStepTicks;
+static Time_T iLastFrame;
+static Time_T iBanked;
+
 /* Initialize the timing module. */
 void Timer_init(int iFrameRate) {
    dInverseRate = (double)iFrameRate;
+   iSynthetic = 0;
+   iStepTicks = STEP_TICKS(iFrameRate);
+   iLastFrame = Timer_getTime();
+   iBanked = 0;
+}
+
+/* Initialize the timing module with a synthetic clock, which starts at zero
+   and only moves when Timer_advance is called.  SDL is never asked for the
+   time, so this works without SDL being initialized. */
+void Timer_initSynthetic(int iFrameRate) {
+   dInverseRate = (double)iFrameRate;
+   iSynthetic = 1;
+   iSyntheticTime = 0;
+   iStepTicks = STEP_TICKS(iFrameRate);
+   iLastFrame = 0;
+   iBanked = 0;
+}
+
+/* Move the synthetic clock forward by iTicks milliseconds.  It is a checked
+   runtime error for the clock not to be synthetic. */
+void Timer_advance(Time_T iTicks) {
+   assert(iSynthetic);
+   iSyntheticTime += iTicks;
+}
+
+/* Start a frame of the fixed step simulation.  The time since the last
+   frame is banked, and the number of whole steps of Timer_getStep now due is
+   drawn out of the bank and returned.  At most iMaxSteps are returned; any
+   more time than that is dropped, so a slow frame slows the game down
+   rather than making the next frame slower still. */
+int Timer_startFrame(int iMaxSteps) {
+   Time_T iNow = Timer_getTime();
+   int iSteps;
+
+   assert(iMaxSteps > 0);
+   iBanked += iNow - iLastFrame;
+   iLastFrame = iNow;
+
+   iSteps = (int)(iBanked / iStepTicks);
+   if (iSteps > iMaxSteps) {
+      iSteps = iMaxSteps;
+      iBanked = 0;
+   }
+   else
+      iBanked -= iSteps * iStepTicks;
+   return iSteps;
+}
+
+/* Return the length of one simulation step, in the same units as
+   Timer_getMultiplier. */
+double Timer_getStep() {
+   return (double)iStepTicks / dInverseRate;
+}
+
+/* Return how far the clock is between the last simulation step and the
+   next one, from 0 up to 1.  Used to blend poses when drawing. */
+double Timer_getBlend() {
+   return (double)iBanked / iStepTicks;
 }
 
 /* Return the current time. */
 Time_T Timer_getTime() {
+   if (iSynthetic)
+      return iSyntheticTime;
    return SDL_GetTicks();
 }
 
 /* Return the time multiplier for updating given oLastUpdate. */
 double Timer_getMultiplier(Time_T oLastUpdate) {
-   return (double)(SDL_GetTicks() - oLastUpdate) / dInverseRate;
+   return (double)(Timer_getTime() - oLastUpdate) / dInverseRate;
 }
@@ -41,6 +41,30 @@ typedef Uint32 Time_T;
 /* Initialize the timing module. */
 void Timer_init(int iFrameRate);
 
+/* Initialize the timing module with a synthetic clock, which starts at zero
+   and only moves when Timer_advance is called.  SDL is never asked for the
+   time, so this works without SDL being initialized. */
+void Timer_initSynthetic(int iFrameRate);
+
+/* Move the synthetic clock forward by iTicks milliseconds.  It is a checked
+   runtime error for the clock not to be synthetic. */
+void Timer_advance(Time_T iTicks);
+
+/* Start a frame of the fixed step simulation.  The time since the last
+   frame is banked, and the number of whole steps of Timer_getStep now due is
+   drawn out of the bank and returned.  At most iMaxSteps are returned; any
+   more time than that is dropped, so a slow frame slows the game down
+   rather than making the next frame slower still. */
+int Timer_startFrame(int iMaxSteps);
+
+/* Return the length of one simulation step, in the same units as
+   Timer_getMultiplier. */
+double Timer_getStep();
+
+/* Return how far the clock is between the last simulation step and the
+   next one, from 0 up to 1.  Used to blend poses when drawing. */
+double Timer_getBlend();
+
 /* Return the current time. */
 Time_T Timer_getTime();
 
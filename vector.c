@@ -30,22 +30,25 @@
 
 #include "vector.h"
 #include "draw.h"
+#include "render.h"
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* Structure to store the Vector datatype. */
 struct Vector {
-       double dX;
-       double dY;
+       Vec2_T oValue;
        };
 
 /* Returns a new Vector_T with x-value X and y-value Y. */
 Vector_T Vector_new(double X, double Y) {
    Vector_T oNewVec = malloc(sizeof(struct Vector));
    assert(oNewVec != NULL);
-   oNewVec->dX = X;
-   oNewVec->dY = Y;
+   oNewVec->oValue = Vec2_make(X, Y);
    return oNewVec;
 }
 
@@ -54,42 +57,53 @@ void Vector_free(Vector_T oVector) {
    free(oVector);
 }
 
+/* Returns the value of oVector as a Vec2_T.  It is a checked runtime error
+   for oVector to be NULL. */
+Vec2_T Vector_get(Vector_T oVector) {
+   assert(oVector != NULL);
+   return oVector->oValue;
+}
+
+/* Sets the value of oVector to be oValue.  It is a checked runtime error for
+   oVector to be NULL. */
+void Vector_set(Vector_T oVector, Vec2_T oValue) {
+   assert(oVector != NULL);
+   oVector->oValue = oValue;
+}
+
 /* Returns the x-value of oVector.  It is a checked runtime error for oVector
    to be NULL. */
 double Vector_getX(Vector_T oVector) {
    assert(oVector != NULL);
-   return(oVector->dX);
+   return(oVector->oValue.dX);
 }
 
 /* Returns the y-value of oVector.  It is a checked runtime error for oVector
    to be NULL. */
 double Vector_getY(Vector_T oVector) {
    assert(oVector != NULL);
-   return(oVector->dY);
+   return(oVector->oValue.dY);
 }
 
 /* Sets the x-value of oVector to be equal to X.  It is a checked runtime
    error for oVector to be NULL. */
 void Vector_setX(Vector_T oVector, double X) {
    assert(oVector != NULL);
-   oVector->dX = X;
+   oVector->oValue.dX = X;
 }
 
 /* Sets the y-value of oVector to be equal to Y.  It is a checked runtime
    error for oVector to be NULL. */
 void Vector_setY(Vector_T oVector, double Y) {
    assert(oVector != NULL);
-   oVector->dY = Y;
+   oVector->oValue.dY = Y;
 }
 
 /* Returns a deep copy of the vector oVector.  It is a checked runtime error
    for oVector to be NULL. */
 Vector_T Vector_copy(Vector_T oVector) {
-   Vector_T oResult = malloc(sizeof(struct Vector));
-   assert (oVector != NULL && oResult != NULL);
-   oResult->dX = oVector->dX;
-   oResult->dY = oVector->dY;
-   return oResult;
+   assert(oVector != NULL);
+   return Vector_new(oVector->oValue.dX, oVector->oValue.dY);
 }
 
 /* Returns the resultant vector after the summation of oVec1 and oVec2.  It is
@@ -97,11 +111,10 @@ Vector_T Vector_copy(Vector_T oVector) {
    WARNING: a line like v = Vector_sum(v, v2) will cause a memory leak, as
    a new Vector object is created to store the result of the addition. */
 Vector_T Vector_sum(Vector_T oVec1, Vector_T oVec2) {
-   Vector_T oResult = malloc(sizeof(struct Vector));
-   assert(oVec1 != NULL && oVec2 != NULL && oResult != NULL);
-   oResult->dX = oVec1->dX + oVec2->dX;
-   oResult->dY = oVec1->dY + oVec2->dY;
-   return oResult;
+   Vec2_T oResult;
+   assert(oVec1 != NULL && oVec2 != NULL);
+   oResult = Vec2_sum(oVec1->oValue, oVec2->oValue);
+   return Vector_new(oResult.dX, oResult.dY);
 }
 
 /* Returns resultant vector after the subtraction of oVec2 from oVec1.  It is
@@ -109,27 +122,24 @@ Vector_T Vector_sum(Vector_T oVec1, Vector_T oVec2) {
    WARNING: a line like v = Vector_diff(v, v2) will cause a memory leak, as
    a new Vector object is created to store the result of the addition. */
 Vector_T Vector_diff(Vector_T oVec1, Vector_T oVec2) {
-   Vector_T oResult = malloc(sizeof(struct Vector));
-   assert(oVec1 != NULL && oVec2 != NULL && oResult != NULL);
-   oResult->dX = oVec1->dX - oVec2->dX;
-   oResult->dY = oVec1->dY - oVec2->dY;
-   return oResult;
+   Vec2_T oResult;
+   assert(oVec1 != NULL && oVec2 != NULL);
+   oResult = Vec2_diff(oVec1->oValue, oVec2->oValue);
+   return Vector_new(oResult.dX, oResult.dY);
 }
 
 /* Adds oVecInc to oVecResult.  It is a checked runtime error for either
    oVecResult or oVecInc to be NULL. */
 void Vector_plus(Vector_T oVecResult, Vector_T oVecInc) {
    assert(oVecResult != NULL && oVecInc != NULL);
-   oVecResult->dX = oVecResult->dX + oVecInc->dX;
-   oVecResult->dY = oVecResult->dY + oVecInc->dY;
+   oVecResult->oValue = Vec2_sum(oVecResult->oValue, oVecInc->oValue);
 }
 
 /* Subtracts oVecDec from oVecResult.  It is a checked runtime error for
    either oVecResult or oVecDec to be NULL. */
 void Vector_minus(Vector_T oVecResult, Vector_T oVecDec) {
    assert(oVecResult != NULL && oVecDec != NULL);
-   oVecResult->dX = oVecResult->dX - oVecDec->dX;
-   oVecResult->dY = oVecResult->dY - oVecDec->dY;
+   oVecResult->oValue = Vec2_diff(oVecResult->oValue, oVecDec->oValue);
 }
 
 /* Returns the signed magnitude of the cross product taken between
@@ -137,7 +147,7 @@ void Vector_minus(Vector_T oVecResult, Vector_T oVecDec) {
    to be NULL. */
 double Vector_magCross(Vector_T oVec1, Vector_T oVec2) {
    assert(oVec1 != NULL && oVec2 != NULL);
-   return oVec1->dX * oVec2->dY - oVec1->dY * oVec2->dX;
+   return Vec2_cross(oVec1->oValue, oVec2->oValue);
 }
 
 /* Returns the resultant double after the dot product is taken between oVec1
@@ -145,57 +155,96 @@ double Vector_magCross(Vector_T oVec1, Vector_T oVec2) {
    NULL. */
 double Vector_dot(Vector_T oVec1, Vector_T oVec2) {
    assert(oVec1 != NULL && oVec2 != NULL);
-   return(oVec1->dX * oVec2->dX + oVec1->dY * oVec2->dY);
+   return Vec2_dot(oVec1->oValue, oVec2->oValue);
 }
 
 /* Returns the length of oVector.  It is a checked runtime error for oVector
    to be NULL. */
 double Vector_length(Vector_T oVector) {
-   double squares;
    assert(oVector != NULL);
-   squares = oVector->dX * oVector->dX + oVector->dY * oVector->dY;
-   return sqrt(squares);
+   return Vec2_length(oVector->oValue);
 }
 
 /* Scales oVector by the scaling factor dScale.  It is a checked runtime error
    for oVector to be NULL. */
 void Vector_scale(Vector_T oVector, double dScale) {
    assert(oVector != NULL);
-   oVector->dX *= dScale;
-   oVector->dY *= dScale;
+   oVector->oValue = Vec2_scale(oVector->oValue, dScale);
 }
 
 /* Normalizes oVector.  It is a checked runtime error for oVector to be
    NULL. */
 void Vector_normalize(Vector_T oVector) {
    assert(oVector != NULL);
-   Vector_scale(oVector, 1 / Vector_length(oVector));
+   oVector->oValue = Vec2_normalize(oVector->oValue);
 }
 
 /* Rotates oVector by angle dTheta.  It is a checked runtime error for oVector
    to be NULL. */
 void Vector_rotate(Vector_T oVector, double dTheta) {
-   double dCos, dSin, xNew, yNew;
-
    assert(oVector != NULL);
-   dCos = cos(dTheta);
-   dSin = sin(dTheta);
-   xNew = oVector->dX * dCos - oVector->dY * dSin;
-   yNew = oVector->dY * dCos + oVector->dX * dSin;
-   oVector->dX = xNew;
-   oVector->dY = yNew;
+   oVector->oValue = Vec2_rotate(oVector->oValue, dTheta);
 }
 
 /* Draws a pixel cooresponding to the position represented by oVector in the
    color iColor.  It is a checked runtime error for oVector to be null. */
 void Vector_draw(Vector_T oVector, Color_T iColor) {
    assert(oVector != NULL);
-   Draw_drawScaledPixel(oVector->dX, oVector->dY, iColor);
+   Vec2_draw(oVector->oValue, iColor);
 }
 
 /* Draws a line between the endpoints of oVec1 and oVec2 in the color iColor.
    It is a checked runtime error for oVec1 or oVec2 to be null. */
 void Vector_drawBetween(Vector_T oVec1, Vector_T oVec2, Color_T iColor) {
    assert((oVec1 != NULL) && (oVec2 != NULL));
-   Draw_drawScaledLine(oVec1->dX, oVec1->dY, oVec2->dX, oVec2->dY, iColor);
+   Vec2_drawBetween(oVec1->oValue, oVec2->oValue, iColor);
+}
+
+/* Moves the iCount body space points (pdX[i], pdY[i]) into world space by
+   oPose, writing them to (pdOutX[i], pdOutY[i]), as Pose_transform would
+   but several at a time.  It is a checked runtime error for any of the
+   arrays to be NULL. */
+void Pose_transformPoints(Pose_T oPose, const double* pdX, const double* pdY,
+                          int iCount, double* pdOutX, double* pdOutY) {
+   int i = 0;
+
+   assert(pdX != NULL && pdY != NULL && pdOutX != NULL && pdOutY != NULL);
+
+#if defined(__SSE2__)
+   {
+      /* Two points at a time, in the same order of operations as
+         Pose_transform, so the results are the same to the last bit. */
+      __m128d vCos = _mm_set1_pd(oPose.dCos), vSin = _mm_set1_pd(oPose.dSin);
+      __m128d vPosX = _mm_set1_pd(oPose.oPos.dX);
+      __m128d vPosY = _mm_set1_pd(oPose.oPos.dY);
+      __m128d vX, vY;
+      for (; i + 2 <= iCount; i += 2) {
+         vX = _mm_loadu_pd(pdX + i);
+         vY = _mm_loadu_pd(pdY + i);
+         _mm_storeu_pd(pdOutX + i,
+                       _mm_add_pd(vPosX, _mm_sub_pd(_mm_mul_pd(vX, vCos),
+                                                    _mm_mul_pd(vY, vSin))));
+         _mm_storeu_pd(pdOutY + i,
+                       _mm_add_pd(vPosY, _mm_add_pd(_mm_mul_pd(vY, vCos),
+                                                    _mm_mul_pd(vX, vSin))));
+      }
+   }
+#endif
+   for (; i < iCount; i++) {
+      pdOutX[i] = oPose.oPos.dX + (pdX[i] * oPose.dCos - pdY[i] * oPose.dSin);
+      pdOutY[i] = oPose.oPos.dY + (pdY[i] * oPose.dCos + pdX[i] * oPose.dSin);
+   }
+}
+
+/* Draws a pixel cooresponding to the position represented by oVector in the
+   color iColor. */
+void Vec2_draw(Vec2_T oVector, Color_T iColor) {
+   Render_point(oVector.dX, oVector.dY, iColor, RENDER_LAYER_OVERLAY);
+}
+
+/* Draws a line between the endpoints of oVec1 and oVec2 in the color
+   iColor. */
+void Vec2_drawBetween(Vec2_T oVec1, Vec2_T oVec2, Color_T iColor) {
+   Render_line(oVec1.dX, oVec1.dY, oVec2.dX, oVec2.dY, iColor,
+               RENDER_LAYER_OVERLAY);
 }
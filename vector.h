@@ -32,9 +32,152 @@
 #define VECTOR_H
 
 #include "draw.h"
+#include <math.h>
 
 typedef struct Vector* Vector_T;
 
+/* Vec2_T is a plain value type for two dimensional vectors.  Unlike a
+   Vector_T it is passed and returned by value, so arithmetic on it never
+   touches the heap.  Use it for anything that happens once per frame. */
+typedef struct Vec2 {
+       double dX;
+       double dY;
+       } Vec2_T;
+
+/* The arithmetic below is small enough that it should be inlined into the
+   callers.  Plain ANSI C has no inline keyword, so fall back on static. */
+#ifdef __GNUC__
+#define VECTOR_INLINE static __inline__
+#else
+#define VECTOR_INLINE static
+#endif
+
+/* Returns the Vec2_T with x-value X and y-value Y. */
+VECTOR_INLINE Vec2_T Vec2_make(double X, double Y) {
+   Vec2_T oResult;
+   oResult.dX = X;
+   oResult.dY = Y;
+   return oResult;
+}
+
+/* Returns the sum of oVec1 and oVec2. */
+VECTOR_INLINE Vec2_T Vec2_sum(Vec2_T oVec1, Vec2_T oVec2) {
+   return Vec2_make(oVec1.dX + oVec2.dX, oVec1.dY + oVec2.dY);
+}
+
+/* Returns the result of subtracting oVec2 from oVec1. */
+VECTOR_INLINE Vec2_T Vec2_diff(Vec2_T oVec1, Vec2_T oVec2) {
+   return Vec2_make(oVec1.dX - oVec2.dX, oVec1.dY - oVec2.dY);
+}
+
+/* Returns oVector scaled by the scaling factor dScale. */
+VECTOR_INLINE Vec2_T Vec2_scale(Vec2_T oVector, double dScale) {
+   return Vec2_make(oVector.dX * dScale, oVector.dY * dScale);
+}
+
+/* Returns the dot product of oVec1 and oVec2. */
+VECTOR_INLINE double Vec2_dot(Vec2_T oVec1, Vec2_T oVec2) {
+   return oVec1.dX * oVec2.dX + oVec1.dY * oVec2.dY;
+}
+
+/* Returns the signed magnitude of the cross product taken between oVec1 and
+   oVec2. */
+VECTOR_INLINE double Vec2_cross(Vec2_T oVec1, Vec2_T oVec2) {
+   return oVec1.dX * oVec2.dY - oVec1.dY * oVec2.dX;
+}
+
+/* Returns the length of oVector. */
+VECTOR_INLINE double Vec2_length(Vec2_T oVector) {
+   return sqrt(Vec2_dot(oVector, oVector));
+}
+
+/* Returns oVector scaled to unit length. */
+VECTOR_INLINE Vec2_T Vec2_normalize(Vec2_T oVector) {
+   return Vec2_scale(oVector, 1 / Vec2_length(oVector));
+}
+
+/* Returns oVector rotated by the angle whose cosine is dCos and whose sine is
+   dSin.  Use this rather than Vec2_rotate when rotating several vectors by
+   the same angle so the trig is only done once. */
+VECTOR_INLINE Vec2_T Vec2_rotateCS(Vec2_T oVector, double dCos, double dSin) {
+   return Vec2_make(oVector.dX * dCos - oVector.dY * dSin,
+                    oVector.dY * dCos + oVector.dX * dSin);
+}
+
+/* Returns oVector rotated by angle dTheta. */
+VECTOR_INLINE Vec2_T Vec2_rotate(Vec2_T oVector, double dTheta) {
+   return Vec2_rotateCS(oVector, cos(dTheta), sin(dTheta));
+}
+
+/* Pose_T is the position and orientation of a rigid body.  The cosine and
+   sine of the orientation are cached so that moving points from body space
+   into world space needs no trig. */
+typedef struct Pose {
+       Vec2_T oPos;
+       double dTheta;
+       double dCos;
+       double dSin;
+       } Pose_T;
+
+/* Returns the Pose_T at position (X, Y) with orientation dTheta. */
+VECTOR_INLINE Pose_T Pose_make(double X, double Y, double dTheta) {
+   Pose_T oResult;
+   oResult.oPos = Vec2_make(X, Y);
+   oResult.dTheta = dTheta;
+   oResult.dCos = cos(dTheta);
+   oResult.dSin = sin(dTheta);
+   return oResult;
+}
+
+/* Returns the body space direction oVector rotated into world space by
+   oPose. */
+VECTOR_INLINE Vec2_T Pose_rotate(Pose_T oPose, Vec2_T oVector) {
+   return Vec2_rotateCS(oVector, oPose.dCos, oPose.dSin);
+}
+
+/* Returns the body space point oPoint moved into world space by oPose. */
+VECTOR_INLINE Vec2_T Pose_transform(Pose_T oPose, Vec2_T oPoint) {
+   return Vec2_sum(oPose.oPos, Pose_rotate(oPose, oPoint));
+}
+
+/* Returns the pose dBlend of the way from oFrom to oTo, for drawing a body
+   between two simulation steps.  A dBlend of 0 gives oFrom and 1 gives
+   oTo. */
+VECTOR_INLINE Pose_T Pose_lerp(Pose_T oFrom, Pose_T oTo, double dBlend) {
+   if (dBlend >= 1)
+      return oTo;
+   return Pose_make(oFrom.oPos.dX + (oTo.oPos.dX - oFrom.oPos.dX) * dBlend,
+                    oFrom.oPos.dY + (oTo.oPos.dY - oFrom.oPos.dY) * dBlend,
+                    oFrom.dTheta + (oTo.dTheta - oFrom.dTheta) * dBlend);
+}
+
+/* Moves the iCount body space points (pdX[i], pdY[i]) into world space by
+   oPose, writing them to (pdOutX[i], pdOutY[i]), as Pose_transform would
+   but several at a time.  It is a checked runtime error for any of the
+   arrays to be NULL. */
+void Pose_transformPoints(Pose_T oPose, const double* pdX, const double* pdY,
+                          int iCount, double* pdOutX, double* pdOutY);
+
+/* Draws a pixel cooresponding to the position represented by oVector in the
+   color iColor. */
+void Vec2_draw(Vec2_T oVector, Color_T iColor);
+
+/* Draws a line between the endpoints of oVec1 and oVec2 in the color
+   iColor. */
+void Vec2_drawBetween(Vec2_T oVec1, Vec2_T oVec2, Color_T iColor);
+
+/* The Vector_T functions below are a compatibility layer over Vec2_T.  Each
+   Vector_T is a separately allocated object, so avoid them in code that
+   runs every frame. */
+
+/* Returns the value of oVector as a Vec2_T.  It is a checked runtime error
+   for oVector to be NULL. */
+Vec2_T Vector_get(Vector_T oVector);
+
+/* Sets the value of oVector to be oValue.  It is a checked runtime error for
+   oVector to be NULL. */
+void Vector_set(Vector_T oVector, Vec2_T oValue);
+
 /* Returns a new Vector_T with x-value X and y-value Y. */
 Vector_T Vector_new(double X, double Y);
 
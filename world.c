@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: world.c defines the implementation for the World ADT.
+ *    Ships are packed into one array, so the loops sweep straight through
+ *    it.  Handles go through a table of slots instead, which keeps them
+ *    valid as ships move within the array; freed slots are kept on a list
+ *    and reused, so spawning and despawning take constant time.  The AI
+ *    and integration loops hand out runs of ships to a pool of threads;
+ *    each ship only changes itself, so the result does not depend on how
+ *    many threads there are.  The follow controllers are packed in the
+ *    same order as the ships, so each run of ships steers with one pass
+ *    over its run of controllers.
+ ___________________________________________________________________________*/
+
+#include "world.h"
+#include "pool.h"
+#include "pid.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define INITIAL_CAPACITY 8
+#define SHIPS_PER_JOB 8 /* Ships each thread takes at a time. */
+
+/* One handle's slot.  While its ship is in the world, iIndex is where the
+   ship is packed; while the slot is free, it is the next free slot, or
+   -1. */
+struct Slot {
+       int iIndex;
+       int iGeneration; /* Goes up each time the slot's ship is despawned. */
+       };
+
+/* Structure to store the world datatype. */
+struct World {
+       Ship_T* poShips;  /* The ships, packed from 0 up to iNumShips. */
+       int* piShipSlot;  /* The slot of each ship in poShips. */
+       int iNumShips;
+       int iShipCapacity;
+
+       struct Slot* poSlots;
+       int iNumSlots;
+       int iSlotCapacity;
+       int iFirstFree;
+
+       /* The controllers each ship follows with, numbered as the ships
+          are. */
+       Pid_T oRotation;
+       Pid_T oPosition;
+
+       Pool_T oPool;     /* The threads the loops run on. */
+       };
+
+/* What a loop's jobs need: the world, and the leader to follow or the
+   step to take. */
+struct Phase {
+       World_T oWorld;
+       int iLeader;
+       double dTime;
+       };
+
+/* In house function for returning the slot oId refers to, or NULL if its
+   ship has been despawned. */
+static struct Slot* World_lookup(World_T oWorld, WorldId_T oId) {
+   struct Slot* poSlot;
+
+   if (oId.iSlot < 0 || oId.iSlot >= oWorld->iNumSlots)
+      return NULL;
+   poSlot = &oWorld->poSlots[oId.iSlot];
+   return poSlot->iGeneration == oId.iGeneration ? poSlot : NULL;
+}
+
+/* Returns a new, empty world. */
+World_T World_new(void) {
+   World_T oNewWorld = (World_T)malloc(sizeof(struct World));
+   assert(oNewWorld != NULL);
+
+   oNewWorld->poShips = NULL;
+   oNewWorld->piShipSlot = NULL;
+   oNewWorld->iNumShips = 0;
+   oNewWorld->iShipCapacity = 0;
+   oNewWorld->poSlots = NULL;
+   oNewWorld->iNumSlots = 0;
+   oNewWorld->iSlotCapacity = 0;
+   oNewWorld->iFirstFree = -1;
+   oNewWorld->oRotation = Pid_new();
+   oNewWorld->oPosition = Pid_new();
+   oNewWorld->oPool = Pool_new(0);
+
+   return oNewWorld;
+}
+
+/* Frees oWorld and every ship still in it.  Does nothing if oWorld is
+   NULL. */
+void World_free(World_T oWorld) {
+   int i;
+   if (oWorld == NULL)
+      return;
+   for (i = 0; i < oWorld->iNumShips; i++)
+      Ship_free(oWorld->poShips[i]);
+   free(oWorld->poShips);
+   free(oWorld->piShipSlot);
+   free(oWorld->poSlots);
+   Pid_free(oWorld->oRotation);
+   Pid_free(oWorld->oPosition);
+   Pool_free(oWorld->oPool);
+   free(oWorld);
+}
+
+/* Runs oWorld's loops on iNumThreads threads from now on, counting the
+   one that calls them.  It is a checked runtime error for oWorld to be
+   NULL or for iNumThreads not to be positive. */
+void World_setThreads(World_T oWorld, int iNumThreads) {
+   assert(oWorld != NULL);
+   assert(iNumThreads > 0);
+   Pool_free(oWorld->oPool);
+   oWorld->oPool = Pool_new(iNumThreads - 1);
+}
+
+/* Adds oShip to oWorld, which then owns it, and returns its handle.  It is
+   a checked runtime error for oWorld or oShip to be NULL. */
+WorldId_T World_spawn(World_T oWorld, Ship_T oShip) {
+   WorldId_T oId;
+
+   assert(oWorld != NULL && oShip != NULL);
+
+   if (oWorld->iNumShips == oWorld->iShipCapacity) {
+      oWorld->iShipCapacity = oWorld->iShipCapacity ?
+                              2 * oWorld->iShipCapacity : INITIAL_CAPACITY;
+      oWorld->poShips = (Ship_T*)realloc(oWorld->poShips,
+                                         oWorld->iShipCapacity *
+                                         sizeof(Ship_T));
+      oWorld->piShipSlot = (int*)realloc(oWorld->piShipSlot,
+                                         oWorld->iShipCapacity *
+                                         sizeof(int));
+      assert(oWorld->poShips != NULL && oWorld->piShipSlot != NULL);
+   }
+
+   if (oWorld->iFirstFree != -1) {
+      oId.iSlot = oWorld->iFirstFree;
+      oWorld->iFirstFree = oWorld->poSlots[oId.iSlot].iIndex;
+   }
+   else {
+      if (oWorld->iNumSlots == oWorld->iSlotCapacity) {
+         oWorld->iSlotCapacity = oWorld->iSlotCapacity ?
+                                 2 * oWorld->iSlotCapacity : INITIAL_CAPACITY;
+         oWorld->poSlots = (struct Slot*)realloc(oWorld->poSlots,
+                           oWorld->iSlotCapacity * sizeof(struct Slot));
+         assert(oWorld->poSlots != NULL);
+      }
+      oId.iSlot = oWorld->iNumSlots++;
+      oWorld->poSlots[oId.iSlot].iGeneration = 0;
+   }
+
+   oId.iGeneration = oWorld->poSlots[oId.iSlot].iGeneration;
+   oWorld->poSlots[oId.iSlot].iIndex = oWorld->iNumShips;
+   oWorld->poShips[oWorld->iNumShips] = oShip;
+   oWorld->piShipSlot[oWorld->iNumShips] = oId.iSlot;
+   Pid_add(oWorld->oRotation, Ship_getRotationGains(oShip));
+   Pid_add(oWorld->oPosition, Ship_getPositionGains(oShip));
+   oWorld->iNumShips++;
+   return oId;
+}
+
+/* Removes the ship oId from oWorld and frees it.  Returns 1 if it was
+   there, or zero if oId was already despawned.  The last ship in the world
+   takes its place, so despawning changes the order of the others.  It is a
+   checked runtime error for oWorld to be NULL. */
+int World_despawn(World_T oWorld, WorldId_T oId) {
+   struct Slot* poSlot;
+   int iIndex, iLast;
+
+   assert(oWorld != NULL);
+   poSlot = World_lookup(oWorld, oId);
+   if (poSlot == NULL)
+      return 0;
+
+   /* Move the last ship into the hole. */
+   iIndex = poSlot->iIndex;
+   iLast = --oWorld->iNumShips;
+   Ship_free(oWorld->poShips[iIndex]);
+   oWorld->poShips[iIndex] = oWorld->poShips[iLast];
+   oWorld->piShipSlot[iIndex] = oWorld->piShipSlot[iLast];
+   oWorld->poSlots[oWorld->piShipSlot[iIndex]].iIndex = iIndex;
+   Pid_remove(oWorld->oRotation, iIndex);
+   Pid_remove(oWorld->oPosition, iIndex);
+
+   poSlot->iGeneration++;
+   poSlot->iIndex = oWorld->iFirstFree;
+   oWorld->iFirstFree = oId.iSlot;
+   return 1;
+}
+
+/* Returns the ship oId in oWorld, or NULL if it has been despawned.  It is
+   a checked runtime error for oWorld to be NULL. */
+Ship_T World_getShip(World_T oWorld, WorldId_T oId) {
+   struct Slot* poSlot;
+   assert(oWorld != NULL);
+   poSlot = World_lookup(oWorld, oId);
+   return poSlot != NULL ? oWorld->poShips[poSlot->iIndex] : NULL;
+}
+
+/* Returns the number of ships in oWorld.  They are numbered from 0 up to
+   that, in the order the loops below go through them.  It is a checked
+   runtime error for oWorld to be NULL. */
+int World_getNumShips(World_T oWorld) {
+   assert(oWorld != NULL);
+   return oWorld->iNumShips;
+}
+
+/* Returns ship number i of oWorld.  It is a checked runtime error for
+   oWorld to be NULL or for i not to be a ship's number. */
+Ship_T World_getShipAt(World_T oWorld, int i) {
+   assert(oWorld != NULL);
+   assert(i >= 0 && i < oWorld->iNumShips);
+   return oWorld->poShips[i];
+}
+
+/* Returns the handle of ship number i of oWorld.  It is a checked runtime
+   error for oWorld to be NULL or for i not to be a ship's number. */
+WorldId_T World_getIdAt(World_T oWorld, int i) {
+   WorldId_T oId;
+   assert(oWorld != NULL);
+   assert(i >= 0 && i < oWorld->iNumShips);
+   oId.iSlot = oWorld->piShipSlot[i];
+   oId.iGeneration = oWorld->poSlots[oId.iSlot].iGeneration;
+   return oId;
+}
+
+/* Returns the number of the ship oId in oWorld, or -1 if it has been
+   despawned.  It is a checked runtime error for oWorld to be NULL. */
+int World_getIndex(World_T oWorld, WorldId_T oId) {
+   struct Slot* poSlot;
+   assert(oWorld != NULL);
+   poSlot = World_lookup(oWorld, oId);
+   return poSlot != NULL ? poSlot->iIndex : -1;
+}
+
+/* In house function for steering run iJob of the ships of the phase
+   pvExtra after its leader.  Every ship's errors are worked out first, so
+   that the controllers can all be run in one pass before anyone steers. */
+static void World_followJob(int iJob, int iThread, void* pvExtra) {
+   struct Phase* poPhase = (struct Phase*)pvExtra;
+   World_T oWorld = poPhase->oWorld;
+   Ship_T oLeaderShip = oWorld->poShips[poPhase->iLeader];
+   double adRotError[SHIPS_PER_JOB], adPosError[SHIPS_PER_JOB];
+   double adRot[SHIPS_PER_JOB], adPos[SHIPS_PER_JOB];
+   double adTime[SHIPS_PER_JOB];
+   int aisAway[SHIPS_PER_JOB];
+   int iFirst = iJob * SHIPS_PER_JOB, iCount = SHIPS_PER_JOB, iSkip, i;
+
+   if (iFirst + iCount > oWorld->iNumShips)
+      iCount = oWorld->iNumShips - iFirst;
+   iSkip = poPhase->iLeader - iFirst;
+   if (iSkip < 0 || iSkip >= iCount)
+      iSkip = iCount;
+
+   for (i = 0; i < iCount; i++) {
+      if (i == iSkip)
+         continue;
+      Ship_getFollowErrors(oWorld->poShips[iFirst + i], oLeaderShip,
+                           &adRotError[i], &adPosError[i], &aisAway[i]);
+      adTime[i] = Ship_getStep(oWorld->poShips[iFirst + i]);
+   }
+
+   /* The leader follows no one, so its controllers are left alone: the
+      run is updated either side of it. */
+   Pid_update(oWorld->oRotation, iFirst, iSkip, adRotError, adTime, adRot);
+   Pid_update(oWorld->oPosition, iFirst, iSkip, adPosError, adTime, adPos);
+   if (iSkip + 1 < iCount) {
+      i = iSkip + 1;
+      Pid_update(oWorld->oRotation, iFirst + i, iCount - i, adRotError + i,
+                 adTime + i, adRot + i);
+      Pid_update(oWorld->oPosition, iFirst + i, iCount - i, adPosError + i,
+                 adTime + i, adPos + i);
+   }
+
+   for (i = 0; i < iCount; i++)
+      if (i != iSkip)
+         Ship_steer(oWorld->poShips[iFirst + i], adRot[i], adPos[i],
+                    aisAway[i]);
+}
+
+/* Steers every ship in oWorld but oLeader after it, each with the rotation
+   and position controllers of its class, sharing the ships out among
+   oWorld's threads.  Does nothing if oLeader has been despawned.  It is a
+   checked runtime error for oWorld to be NULL. */
+void World_followShip(World_T oWorld, WorldId_T oLeader) {
+   struct Phase oPhase;
+
+   assert(oWorld != NULL);
+   oPhase.oWorld = oWorld;
+   oPhase.iLeader = World_getIndex(oWorld, oLeader);
+   if (oPhase.iLeader < 0)
+      return;
+   Pool_run(oWorld->oPool, World_followJob,
+            (oWorld->iNumShips + SHIPS_PER_JOB - 1) / SHIPS_PER_JOB, &oPhase);
+}
+
+/* In house function for integrating run iJob of the ships of the phase
+   pvExtra. */
+static void World_integrateJob(int iJob, int iThread, void* pvExtra) {
+   struct Phase* poPhase = (struct Phase*)pvExtra;
+   World_T oWorld = poPhase->oWorld;
+   int iEnd = (iJob + 1) * SHIPS_PER_JOB, i;
+
+   if (iEnd > oWorld->iNumShips)
+      iEnd = oWorld->iNumShips;
+   for (i = iJob * SHIPS_PER_JOB; i < iEnd; i++)
+      if (i != poPhase->iLeader)
+         Ship_integrate(oWorld->poShips[i], poPhase->dTime);
+}
+
+/* In house function for integrating the leader of the phase pvExtra, as
+   the one job of its phase. */
+static void World_integrateLeaderJob(int iJob, int iThread, void* pvExtra) {
+   struct Phase* poPhase = (struct Phase*)pvExtra;
+   Ship_integrate(poPhase->oWorld->poShips[poPhase->iLeader],
+                  poPhase->dTime);
+}
+
+/* Moves every ship in oWorld on by a step of dTime, as
+   Ship_applyVelocities does, sharing the ships out among oWorld's threads.
+   It is a checked runtime error for oWorld to be NULL. */
+void World_applyVelocities(World_T oWorld, double dTime) {
+   struct Phase oPhase;
+   int i;
+
+   assert(oWorld != NULL);
+   oPhase.oWorld = oWorld;
+   oPhase.iLeader = -1;
+   oPhase.dTime = dTime;
+   Pool_run(oWorld->oPool, World_integrateJob,
+            (oWorld->iNumShips + SHIPS_PER_JOB - 1) / SHIPS_PER_JOB, &oPhase);
+
+   /* The broad phase is shared, so every ship is moved in it here, once
+      all of them have been integrated. */
+   for (i = 0; i < oWorld->iNumShips; i++)
+      Ship_updateBroadPhase(oWorld->poShips[i]);
+}
+
+/* Steers every ship in oWorld but oLeader after it, then moves every ship
+   on by a step of dTime, as World_followShip and then
+   World_applyVelocities do.  The two are run as one graph, so a run of
+   ships is integrated as soon as it has been steered while the threads
+   share out the rest; only the leader, which every ship steers by, waits
+   for all of them.  Just moves the ships if oLeader has been despawned.
+   It is a checked runtime error for oWorld to be NULL. */
+void World_step(World_T oWorld, WorldId_T oLeader, double dTime) {
+   struct Phase oPhase;
+   int iNumJobs, iFollow, i;
+
+   assert(oWorld != NULL);
+   oPhase.oWorld = oWorld;
+   oPhase.iLeader = World_getIndex(oWorld, oLeader);
+   oPhase.dTime = dTime;
+   if (oPhase.iLeader < 0) {
+      World_applyVelocities(oWorld, dTime);
+      return;
+   }
+   iNumJobs = (oWorld->iNumShips + SHIPS_PER_JOB - 1) / SHIPS_PER_JOB;
+
+   iFollow = Pool_addPhase(oWorld->oPool, World_followJob, iNumJobs,
+                           &oPhase);
+   Pool_afterEach(oWorld->oPool,
+                  Pool_addPhase(oWorld->oPool, World_integrateJob, iNumJobs,
+                                &oPhase), iFollow);
+   Pool_after(oWorld->oPool,
+              Pool_addPhase(oWorld->oPool, World_integrateLeaderJob, 1,
+                            &oPhase), iFollow);
+   Pool_runGraph(oWorld->oPool);
+
+   for (i = 0; i < oWorld->iNumShips; i++)
+      Ship_updateBroadPhase(oWorld->poShips[i]);
+}
+
+/* Records every ship in oWorld for drawing, blended dBlend of the way from
+   its last pose to its current one, as Ship_draw does.  It is a checked
+   runtime error for oWorld to be NULL. */
+void World_draw(World_T oWorld, double dBlend) {
+   int i;
+   assert(oWorld != NULL);
+   for (i = 0; i < oWorld->iNumShips; i++)
+      Ship_draw(oWorld->poShips[i], dBlend);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2005-2008 Michael Dirolf (mike at dirolf dot com)
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*____________________________________________________________________________
+ * date: 10/17/2026
+ * description: world.h defines the interface for the World ADT, which owns
+ *    every ship in a scene and runs each frame's loops over all of them.
+ ___________________________________________________________________________*/
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "ship.h"
+
+typedef struct World* World_T;
+
+/* A handle to a ship in a world.  A handle only ever finds the ship it was
+   given for: once that ship is despawned, its slot may be reused, but the
+   generation will no longer match. */
+typedef struct WorldId {
+       int iSlot;
+       int iGeneration;
+       } WorldId_T;
+
+/* Returns a new, empty world. */
+World_T World_new(void);
+
+/* Frees oWorld and every ship still in it.  Does nothing if oWorld is
+   NULL. */
+void World_free(World_T oWorld);
+
+/* Runs oWorld's loops on iNumThreads threads from now on, counting the
+   one that calls them.  It is a checked runtime error for oWorld to be
+   NULL or for iNumThreads not to be positive. */
+void World_setThreads(World_T oWorld, int iNumThreads);
+
+/* Adds oShip to oWorld, which then owns it, and returns its handle.  It is
+   a checked runtime error for oWorld or oShip to be NULL. */
+WorldId_T World_spawn(World_T oWorld, Ship_T oShip);
+
+/* Removes the ship oId from oWorld and frees it.  Returns 1 if it was
+   there, or zero if oId was already despawned.  The last ship in the world
+   takes its place, so despawning changes the order of the others.  It is a
+   checked runtime error for oWorld to be NULL. */
+int World_despawn(World_T oWorld, WorldId_T oId);
+
+/* Returns the ship oId in oWorld, or NULL if it has been despawned.  It is
+   a checked runtime error for oWorld to be NULL. */
+Ship_T World_getShip(World_T oWorld, WorldId_T oId);
+
+/* Returns the number of ships in oWorld.  They are numbered from 0 up to
+   that, in the order the loops below go through them.  It is a checked
+   runtime error for oWorld to be NULL. */
+int World_getNumShips(World_T oWorld);
+
+/* Returns ship number i of oWorld.  It is a checked runtime error for
+   oWorld to be NULL or for i not to be a ship's number. */
+Ship_T World_getShipAt(World_T oWorld, int i);
+
+/* Returns the handle of ship number i of oWorld.  It is a checked runtime
+   error for oWorld to be NULL or for i not to be a ship's number. */
+WorldId_T World_getIdAt(World_T oWorld, int i);
+
+/* Returns the number of the ship oId in oWorld, or -1 if it has been
+   despawned.  It is a checked runtime error for oWorld to be NULL. */
+int World_getIndex(World_T oWorld, WorldId_T oId);
+
+/* Steers every ship in oWorld but oLeader after it, each with the rotation
+   and position controllers of its class, sharing the ships out among
+   oWorld's threads.  Does nothing if oLeader has been despawned.  It is a
+   checked runtime error for oWorld to be NULL. */
+void World_followShip(World_T oWorld, WorldId_T oLeader);
+
+/* Moves every ship in oWorld on by a step of dTime, as
+   Ship_applyVelocities does, sharing the ships out among oWorld's threads.
+   It is a checked runtime error for oWorld to be NULL. */
+void World_applyVelocities(World_T oWorld, double dTime);
+
+/* Steers every ship in oWorld but oLeader after it, then moves every ship
+   on by a step of dTime, as World_followShip and then
+   World_applyVelocities do.  The two are run as one graph, so a run of
+   ships is integrated as soon as it has been steered while the threads
+   share out the rest; only the leader, which every ship steers by, waits
+   for all of them.  Just moves the ships if oLeader has been despawned.
+   It is a checked runtime error for oWorld to be NULL. */
+void World_step(World_T oWorld, WorldId_T oLeader, double dTime);
+
+/* Records every ship in oWorld for drawing, blended dBlend of the way from
+   its last pose to its current one, as Ship_draw does.  It is a checked
+   runtime error for oWorld to be NULL. */
+void World_draw(World_T oWorld, double dBlend);
+
+#endif